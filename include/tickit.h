@@ -154,6 +154,7 @@ typedef enum {
     TICKIT_WINCTL_CURSORVIS,
     TICKIT_WINCTL_CURSORBLINK,
     TICKIT_WINCTL_CURSORSHAPE,
+    TICKIT_WINCTL_BACKING_STORE,
 
     TICKIT_N_WINCTLS
 } TickitWindowCtl;
@@ -534,6 +535,7 @@ TickitRenderBuffer *tickit_renderbuffer_ref(TickitRenderBuffer *rb);
 void tickit_renderbuffer_unref(TickitRenderBuffer *rb);
 
 void tickit_renderbuffer_get_size(const TickitRenderBuffer *rb, int *lines, int *cols);
+void tickit_renderbuffer_resize(TickitRenderBuffer *rb, int lines, int cols);
 
 void tickit_renderbuffer_translate(TickitRenderBuffer *rb, int downward, int rightward);
 void tickit_renderbuffer_clip(TickitRenderBuffer *rb, TickitRect *rect);
@@ -561,6 +563,10 @@ int tickit_renderbuffer_textn_at(
     TickitRenderBuffer *rb, int line, int col, const char *text, size_t len);
 int tickit_renderbuffer_text(TickitRenderBuffer *rb, const char *text);
 int tickit_renderbuffer_textn(TickitRenderBuffer *rb, const char *text, size_t len);
+int tickit_renderbuffer_textn_borrowed_at(
+    TickitRenderBuffer *rb, int line, int col, const char *text, size_t len, int cols);
+int tickit_renderbuffer_textn_borrowed(
+    TickitRenderBuffer *rb, const char *text, size_t len, int cols);
 int tickit_renderbuffer_textf_at(TickitRenderBuffer *rb, int line, int col, const char *fmt, ...);
 int tickit_renderbuffer_vtextf_at(
     TickitRenderBuffer *rb, int line, int col, const char *fmt, va_list args);
@@ -579,6 +585,38 @@ void tickit_renderbuffer_hline_at(TickitRenderBuffer *rb, int line, int startcol
 void tickit_renderbuffer_vline_at(TickitRenderBuffer *rb, int startline, int endline, int col,
     TickitLineStyle style, TickitLineCaps caps);
 
+typedef enum {
+    TICKIT_RENDERBUFFER_OP_TEXT,
+    TICKIT_RENDERBUFFER_OP_ERASE,
+    TICKIT_RENDERBUFFER_OP_CHAR,
+    TICKIT_RENDERBUFFER_OP_SKIP,
+} TickitRenderBufferOpType;
+
+typedef struct {
+    TickitRenderBufferOpType type;
+    int line, col;
+    const TickitPen *pen;  // merged over the current pen; or NULL to use it as it is
+    union {
+        struct {
+            const char *str;
+            size_t len;  // or -1 if str is nul-terminated
+        } text;
+        int cols;        // ERASE and SKIP
+        long codepoint;  // CHAR
+    } v;
+} TickitRenderBufferOp;
+
+void tickit_renderbuffer_draw_ops(
+    TickitRenderBuffer *rb, const TickitRenderBufferOp *ops, size_t n);
+
+typedef struct {
+    long codepoint;  // or 0 for the second column of a double-width character
+    int pen;         // index into the palette, or -1 to use the current pen
+} TickitRenderBufferCell;
+
+void tickit_renderbuffer_put_cells(TickitRenderBuffer *rb, int line, int col,
+    const TickitRenderBufferCell *cells, size_t n, const TickitPen **palette);
+
 void tickit_renderbuffer_copyrect(
     TickitRenderBuffer *rb, const TickitRect *dest, const TickitRect *src);
 void tickit_renderbuffer_moverect(
@@ -586,7 +624,20 @@ void tickit_renderbuffer_moverect(
 
 void tickit_renderbuffer_flush_to_term(TickitRenderBuffer *rb, TickitTerm *tt);
 
+struct TickitRenderBufferEncodeProfile {
+    bool rgb8;           // pens' RGB8 colours may be used
+    bool csi_sub_colon;  // SGR sub-parameters are separated by ':' rather than ';'
+};
+
+size_t tickit_renderbuffer_encode(TickitRenderBuffer *rb,
+    const struct TickitRenderBufferEncodeProfile *profile, char *buffer, size_t len);
+size_t tickit_renderbuffer_encode_lines(TickitRenderBuffer *rb,
+    const struct TickitRenderBufferEncodeProfile *profile, int startline, int endline,
+    char *buffer, size_t len);
+
 void tickit_renderbuffer_blit(TickitRenderBuffer *dst, TickitRenderBuffer *src);
+void tickit_renderbuffer_blit_at(TickitRenderBuffer *dst, TickitRenderBuffer *src,
+    const TickitRect *srcrect, int dest_line, int dest_col);
 
 // This API is still somewhat experimental
 
@@ -618,6 +669,20 @@ struct TickitRenderBufferSpanInfo {
 size_t tickit_renderbuffer_get_span(TickitRenderBuffer *rb, int line, int startcol,
     struct TickitRenderBufferSpanInfo *info, char *buffer, size_t len);
 
+typedef struct {
+    int line, col;
+    int n_columns;
+    bool is_active;
+    const char *text;  // points into the caller's buffer; nul-terminated
+    size_t len;
+    TickitPen *pen;    // direct pointer, NULL if not active - do not free or modify
+} TickitRenderBufferSpan;
+
+// returns the number of spans filled. Stops early if spans or
+//   buffer run out; continue from the end of the last span returned
+int tickit_renderbuffer_get_spans(TickitRenderBuffer *rb, const TickitRect *rect,
+    TickitRenderBufferSpan *spans, size_t n, char *buffer, size_t len);
+
 /* Window */
 
 TickitWindow *tickit_window_new_root(TickitTerm *term);
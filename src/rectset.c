@@ -91,7 +91,12 @@ void tickit_rectset_add(TickitRectSet *trs, const TickitRect *rect) {
     int left   = rect->left;
     int right  = tickit_rect_right(rect);
 
+    // Stretching below may grow the rect beyond the one we were given
+    TickitRect cur;
+
 restart:
+    tickit_rect_init_bounded(&cur, top, left, bottom, right);
+
     for (int i = 0; i < trs->count; i++) {
         TickitRect *r = trs->rects + i;
         int r_bottom  = tickit_rect_bottom(r);
@@ -105,7 +110,7 @@ restart:
         if (top > r_bottom || left > r_right || right < r->left)
             continue;
 
-        if (tickit_rect_contains(r, rect))
+        if (tickit_rect_contains(r, &cur))
             // Already entirely covered, just return
             return;
 
@@ -140,7 +145,7 @@ restart:
         // it now must be composed of, delete r, then recurse on those to-be-added
         // rects instead.
         TickitRect to_add[3];
-        int n = tickit_rect_add(to_add, r, rect);  // TODO: top/left/bottom/right ?
+        int n = tickit_rect_add(to_add, r, &cur);
 
         delete_rect(trs, i);
 
@@ -150,11 +155,8 @@ restart:
     }
 
     // If we got this far then we need to add it
-    TickitRect new;
-    tickit_rect_init_bounded(&new, top, left, bottom, right);
-
     // TODO: error handling
-    insert_rect(trs, &new);
+    insert_rect(trs, &cur);
 }
 
 void tickit_rectset_subtract(TickitRectSet *trs, const TickitRect *rect) {
@@ -1,8 +1,10 @@
 /* We need strdup */
 #define _XOPEN_SOURCE 600
 
+#include "termdriver.h"
 #include "tickit.h"
 
+#include <stdint.h>
 #include <stdio.h>  // vsnprintf
 #include <stdlib.h>
 #include <string.h>
@@ -29,43 +31,104 @@ enum {
     WEST_SHIFT  = 6,
 };
 
-// Internal cell structure definition
+// Internal cell structure definition; kept to 16 bytes so that lines stay
+//   dense in cache. Pens and text are held in the spandata table.
 typedef struct {
-    enum TickitRenderBufferCellState state;
+    uint8_t state;  // enum TickitRenderBufferCellState
+    uint8_t lead;   // state == TEXT: columns of a wide glyph cut off before the span
     union {
-        int startcol;  // for state == CONT
-        int cols;      // otherwise
+        int32_t startcol;  // for state == CONT
+        int32_t cols;      // otherwise
     };
-    int maskdepth;   // -1 if not masked
-    TickitPen *pen;  // state -> {TEXT, ERASE, LINE, CHAR}
+    uint32_t data;  // index into rb->spandata; state -> {TEXT, ERASE, LINE, CHAR}
     union {
         struct {
-            TickitString *s;
-            int offs;
-        } text;  // state == TEXT
+            int32_t bytes;  // offset of the span's first glyph within the text
+        } text;             // state == TEXT
         struct {
-            int mask;
+            int32_t mask;
         } line;  // state == LINE
         struct {
-            int codepoint;
+            int32_t codepoint;
         } chr;  // state == CHAR
     } v;
 } RBCell;
 
-typedef struct RBStack RBStack;
-struct RBStack {
-    RBStack *prev;
+// Text as short as this is kept within its spandata entry itself
+#define SMALLTEXT_MAX 15
+
+enum RBSpanText {
+    SPANTEXT_NONE,
+    SPANTEXT_SHARED,    // a shared string
+    SPANTEXT_ARENA,     // a copy in the render buffer's arena
+    SPANTEXT_BORROWED,  // borrowed from the caller until the next reset
+    SPANTEXT_SMALL,     // a copy within the entry
+};
+
+// Pen and text shared by all of the spans created by one drawing operation
+typedef struct {
+    TickitPen *pen;
+    union {
+        TickitString *s;                // SPANTEXT_SHARED
+        const char *borrowed;           // SPANTEXT_BORROWED; not nul-terminated
+        int32_t textoffs;               // SPANTEXT_ARENA; offset into rb->text
+        char small[SMALLTEXT_MAX + 1];  // SPANTEXT_SMALL; nul-terminated
+    };
+    uint32_t textlen;  // unless SPANTEXT_SHARED
+    int refcount;      // span cells referring to this entry; 0 when free
+    uint32_t next_free;
+    uint8_t text;  // enum RBSpanText
+} RBSpanData;
+
+// Text copies are only stored in the arena while it stays below this size;
+//   beyond it they fall back to separately allocated strings, so a buffer
+//   that is drawn over repeatedly without a reset can't grow without limit
+#define TEXTARENA_MAX (1024 * 1024)
+
+typedef struct {
+    TickitRect rect;  // in buffer coordinates, clipped to the buffer
+    int depth;        // removed again on restoring below this depth
+} RBMask;
+
+// Columns of a line that may hold anything other than skipping; every cell
+//   outside them is part of a SKIP span
+typedef struct {
+    int left, right;
+} RBLineDirty;
+
+#define PENCACHE_SIZE 8
+
+// A pen previously built by tickit_renderbuffer_setpen(), keyed by the
+//   addresses of the pens it was merged from
+typedef struct {
+    const TickitPen *pen, *prevpen;  // only compared, never dereferenced
+    TickitPen *merged;               // NULL if this entry is unused
+} RBPenCacheEntry;
 
+typedef struct {
     int vc_line, vc_col;
     int xlate_line, xlate_col;
     TickitRect clip;
     TickitPen *pen;
     unsigned int pen_only : 1;
-};
+} RBStack;
 
 struct TickitRenderBuffer {
     int lines, cols;  // Size
-    RBCell **cells;
+    RBCell **cells;   // per line; NULL until the line is first drawn to
+    RBCell *blank;    // one entirely skipping line
+
+    /* A line's cells are only meaningful while its dirtymap bit is set; any
+     * other line reads as blank, and is only initialised when next drawn to
+     */
+    uint64_t *dirtymap;   // bitmap of lines that have been drawn to since reset
+    RBLineDirty *dirty;   // per line; only valid while its dirtymap bit is set
+
+    RBSpanData *spandata;
+    uint32_t spandata_size;  // allocated size
+    uint32_t spandata_used;  // high-water mark
+    uint32_t spandata_free;  // head of free list, or spandata_used if empty
+    uint32_t spandata_last;  // most recently created entry
 
     unsigned int vc_pos_set : 1;
     int vc_line, vc_col;
@@ -73,8 +136,28 @@ struct TickitRenderBuffer {
     TickitRect clip;
     TickitPen *pen;
 
+    RBStack *stack;  // the innermost saved state is stack[depth-1]
     int depth;
-    RBStack *stack;
+    int size_stack;
+
+    RBMask *masks;  // ordered by depth
+    int n_masks;
+    int size_masks;
+
+    /* Per line bitsets of the columns the masks cover, each only rebuilt
+     * when its line is next drawn to after the masks change
+     */
+    uint64_t *maskbits;          // maskwords per line; allocated on first use
+    int maskwords;
+    unsigned int *maskbits_gen;  // per line, mask_gen when last rebuilt
+    unsigned int mask_gen;
+
+    RBPenCacheEntry pencache[PENCACHE_SIZE];
+    int pencache_next;  // entry to replace next
+
+    char *text;       // per-frame arena of nul-terminated text copies
+    size_t textlen;   // used; released all at once by reset
+    size_t textsize;  // allocated size
 
     char *tmp;
     size_t tmplen;   // actually valid
@@ -104,26 +187,32 @@ static void debug_logf(TickitRenderBuffer *rb, const char *flag, const char *fmt
     if (tickit_debug_enabled) \
     debug_logf
 
-static void free_stack(RBStack *stack) {
-    while (stack) {
-        RBStack *prev = stack->prev;
-        if (stack->pen)
-            tickit_pen_unref(stack->pen);
-        free(stack);
+// Empties the stack but keeps its storage for reuse
+static void clear_stack(TickitRenderBuffer *rb) {
+    for (int i = 0; i < rb->depth; i++)
+        tickit_pen_unref(rb->stack[i].pen);
+
+    rb->depth = 0;
+}
 
-        stack = prev;
+static RBStack *push_stack(TickitRenderBuffer *rb) {
+    if (rb->depth == rb->size_stack) {
+        rb->size_stack *= 2;
+        rb->stack = realloc(rb->stack, rb->size_stack * sizeof(RBStack));
     }
+
+    return &rb->stack[rb->depth++];
 }
 
-static void tmp_cat_utf8(TickitRenderBuffer *rb, long codepoint) {
-    int seqlen = tickit_utf8_seqlen(codepoint);
-    if (rb->tmpsize < rb->tmplen + seqlen) {
-        rb->tmpsize *= 2;
+static void tmp_cat(TickitRenderBuffer *rb, const char *bytes, size_t len) {
+    if (rb->tmpsize < rb->tmplen + len) {
+        while (rb->tmpsize < rb->tmplen + len)
+            rb->tmpsize *= 2;
         rb->tmp = realloc(rb->tmp, rb->tmpsize);
     }
 
-    tickit_utf8_put(rb->tmp + rb->tmplen, rb->tmpsize - rb->tmplen, codepoint);
-    rb->tmplen += seqlen;
+    memcpy(rb->tmp + rb->tmplen, bytes, len);
+    rb->tmplen += len;
 
     /* rb->tmp remains NOT nul-terminated */
 }
@@ -168,32 +257,289 @@ static int xlate_and_clip(TickitRenderBuffer *rb, int *line, int *col, int *cols
     return 1;
 }
 
-static void cont_cell(RBCell *cell, int startcol) {
+static uint32_t spandata_alloc(TickitRenderBuffer *rb) {
+    uint32_t idx;
+    if (rb->spandata_free < rb->spandata_used) {
+        idx               = rb->spandata_free;
+        rb->spandata_free = rb->spandata[idx].next_free;
+    } else {
+        if (rb->spandata_used == rb->spandata_size) {
+            rb->spandata_size *= 2;
+            rb->spandata = realloc(rb->spandata, rb->spandata_size * sizeof(RBSpanData));
+        }
+        idx = rb->spandata_used++;
+        // the free list is terminated by the high-water mark
+        rb->spandata_free = rb->spandata_used;
+    }
+
+    rb->spandata_last = idx;
+    return idx;
+}
+
+// Returns an entry holding references to pen and s. The caller owns one
+//   reference on the entry, which must be released with spandata_unref()
+static uint32_t spandata_new(TickitRenderBuffer *rb, TickitPen *pen, TickitString *s) {
+    // Consecutive operations often share a pen; there's no need for another
+    //   entry if the last one is still live
+    if (rb->spandata_last < rb->spandata_used) {
+        RBSpanData *last = &rb->spandata[rb->spandata_last];
+        if (last->refcount && last->pen == pen &&
+            (s ? last->text == SPANTEXT_SHARED && last->s == s : last->text == SPANTEXT_NONE)) {
+            last->refcount++;
+            return rb->spandata_last;
+        }
+    }
+
+    uint32_t idx     = spandata_alloc(rb);
+    RBSpanData *data = &rb->spandata[idx];
+    data->pen        = tickit_pen_ref(pen);
+    data->text       = s ? SPANTEXT_SHARED : SPANTEXT_NONE;
+    data->s          = s ? tickit_string_ref(s) : NULL;
+    data->textlen    = 0;
+    data->refcount   = 1;
+
+    return idx;
+}
+
+// As spandata_new() but for a copy of the given text; stored in the entry
+//   itself if it's short enough, else in the arena if there's room for it
+static uint32_t spandata_new_text(
+    TickitRenderBuffer *rb, TickitPen *pen, const char *text, size_t len) {
+    if (len <= SMALLTEXT_MAX) {
+        // text may itself be within an entry, which allocating may move
+        char small[SMALLTEXT_MAX + 1];
+        memcpy(small, text, len);
+        small[len] = '\0';
+
+        uint32_t idx     = spandata_alloc(rb);
+        RBSpanData *data = &rb->spandata[idx];
+        data->pen        = tickit_pen_ref(pen);
+        data->text       = SPANTEXT_SMALL;
+        memcpy(data->small, small, len + 1);
+        data->textlen  = len;
+        data->refcount = 1;
+
+        return idx;
+    }
+
+    if (rb->textlen + len + 1 > TEXTARENA_MAX) {
+        TickitString *s = tickit_string_new(text, len);
+        uint32_t idx    = spandata_new(rb, pen, s);
+        tickit_string_unref(s);
+        return idx;
+    }
+
+    if (rb->textsize < rb->textlen + len + 1) {
+        // text may itself point into the arena, e.g. when copying a rect
+        //   within one buffer
+        bool inarena   = rb->text && text >= rb->text && text < rb->text + rb->textlen;
+        size_t srcoffs = inarena ? text - rb->text : 0;
+
+        if (!rb->textsize)
+            rb->textsize = 1024;
+        while (rb->textsize < rb->textlen + len + 1)
+            rb->textsize *= 2;
+        rb->text = realloc(rb->text, rb->textsize);
+
+        if (inarena)
+            text = rb->text + srcoffs;
+    }
+
+    uint32_t idx     = spandata_alloc(rb);
+    RBSpanData *data = &rb->spandata[idx];
+    data->pen        = tickit_pen_ref(pen);
+    data->text       = SPANTEXT_ARENA;
+    data->textoffs   = rb->textlen;
+    data->textlen    = len;
+    data->refcount   = 1;
+
+    memcpy(rb->text + rb->textlen, text, len);
+    rb->text[rb->textlen + len] = '\0';
+    rb->textlen += len + 1;
+
+    return idx;
+}
+
+// As spandata_new() but for text the caller keeps alive until the next reset
+static uint32_t spandata_new_borrowed(
+    TickitRenderBuffer *rb, TickitPen *pen, const char *text, size_t len) {
+    uint32_t idx     = spandata_alloc(rb);
+    RBSpanData *data = &rb->spandata[idx];
+    data->pen        = tickit_pen_ref(pen);
+    data->text       = SPANTEXT_BORROWED;
+    data->borrowed   = text;
+    data->textlen    = len;
+    data->refcount   = 1;
+
+    return idx;
+}
+
+static uint32_t spandata_ref(TickitRenderBuffer *rb, uint32_t idx) {
+    rb->spandata[idx].refcount++;
+    return idx;
+}
+
+static void spandata_unref(TickitRenderBuffer *rb, uint32_t idx) {
+    RBSpanData *data = &rb->spandata[idx];
+    if (--data->refcount)
+        return;
+
+    tickit_pen_unref(data->pen);
+    if (data->text == SPANTEXT_SHARED)
+        tickit_string_unref(data->s);
+
+    data->next_free   = rb->spandata_free;
+    rb->spandata_free = idx;
+}
+
+// Releases every entry at once; the caller must discard all non-CONT cells
+static void spandata_clear(TickitRenderBuffer *rb) {
+    for (uint32_t idx = 0; idx < rb->spandata_used; idx++) {
+        RBSpanData *data = &rb->spandata[idx];
+        if (!data->refcount)
+            continue;
+
+        tickit_pen_unref(data->pen);
+        if (data->text == SPANTEXT_SHARED)
+            tickit_string_unref(data->s);
+    }
+
+    rb->spandata_used = 0;
+    rb->spandata_free = 0;
+    rb->spandata_last = 0;
+
+    // Nothing refers to the arena any more either
+    rb->textlen = 0;
+}
+
+static inline TickitPen *cell_pen(const TickitRenderBuffer *rb, const RBCell *cell) {
+    return rb->spandata[cell->data].pen;
+}
+
+// The text of an entry and its length in bytes. Borrowed text is not
+//   nul-terminated, so it must only be read within that length. Small text
+//   moves with the entry, so is only valid until the next entry is created
+static inline const char *spandata_text(const TickitRenderBuffer *rb, uint32_t idx, size_t *lenp) {
+    const RBSpanData *data = &rb->spandata[idx];
+    if (data->text == SPANTEXT_SHARED) {
+        *lenp = tickit_string_len(data->s);
+        return tickit_string_get(data->s);
+    }
+
+    *lenp = data->textlen;
+    switch (data->text) {
+        case SPANTEXT_BORROWED:
+            return data->borrowed;
+        case SPANTEXT_SMALL:
+            return data->small;
+        default:
+            return rb->text + data->textoffs;
+    }
+}
+
+static inline const char *cell_text(const TickitRenderBuffer *rb, const RBCell *cell, size_t *lenp) {
+    return spandata_text(rb, cell->data, lenp);
+}
+
+// The text of a TEXT span from its first glyph onwards; pos is set to the
+//   position within that of the given column offset into the span
+static const char *span_text_at(const TickitRenderBuffer *rb, const RBCell *cell, int offset,
+    size_t *lenp, TickitStringPos *pos) {
+    size_t len;
+    const char *text = cell_text(rb, cell, &len);
+
+    text += cell->v.text.bytes;
+    *lenp = len - cell->v.text.bytes;
+
+    TickitStringPos limit;
+    tickit_stringpos_limit_columns(&limit, cell->lead + offset);
+    tickit_utf8_ncount(text, *lenp, pos, &limit);
+
+    return text;
+}
+
+// Sets the byte offset of a TEXT span that starts at the given column of the
+//   text, by counting on from pos; which must not be after that column
+static void set_span_start(RBCell *cell, const char *text, size_t len, TickitStringPos *pos, int col) {
+    TickitStringPos limit;
+    tickit_stringpos_limit_columns(&limit, col);
+    tickit_utf8_ncountmore(text, len, pos, &limit);
+
+    cell->v.text.bytes = pos->bytes;
+    cell->lead         = col - pos->columns;
+}
+
+// Releases the spandata of a span's start cell, if it has any
+static void release_span(TickitRenderBuffer *rb, RBCell *cell) {
     switch (cell->state) {
         case TEXT:
-            tickit_string_unref(cell->v.text.s);
-            /* fallthrough */
         case ERASE:
         case LINE:
         case CHAR:
-            tickit_pen_unref(cell->pen);
+            spandata_unref(rb, cell->data);
             break;
         case SKIP:
         case CONT:
             /* ignore */
             break;
     }
+}
+
+static bool line_is_dirty(const TickitRenderBuffer *rb, int line) {
+    return rb->dirtymap[line / 64] & (UINT64_C(1) << (line % 64));
+}
+
+// The cells of a line for reading; an undrawn line is entirely skipping
+static inline RBCell *line_cells(const TickitRenderBuffer *rb, int line) {
+    return line_is_dirty(rb, line) ? rb->cells[line] : rb->blank;
+}
+
+// Returns the first dirty line at or after line, or rb->lines if none
+static int next_dirty_line(const TickitRenderBuffer *rb, int line) {
+    while (line < rb->lines) {
+        uint64_t word = rb->dirtymap[line / 64] >> (line % 64);
+        if (!word) {
+            line = (line / 64 + 1) * 64;
+            continue;
+        }
+
+        while (!(word & 1)) {
+            word >>= 1;
+            line++;
+        }
+        return line;
+    }
+
+    return rb->lines;
+}
+
+static void mark_dirty(TickitRenderBuffer *rb, int line, int col, int end) {
+    RBLineDirty *dirty = &rb->dirty[line];
+
+    if (!line_is_dirty(rb, line)) {
+        // Whatever the line held before the last reset is stale
+        if (!rb->cells[line])
+            rb->cells[line] = malloc(rb->cols * sizeof(RBCell));
+        memcpy(rb->cells[line], rb->blank, rb->cols * sizeof(RBCell));
+
+        rb->dirtymap[line / 64] |= UINT64_C(1) << (line % 64);
+        dirty->left  = col;
+        dirty->right = end;
+        return;
+    }
 
-    cell->state     = CONT;
-    cell->maskdepth = -1;
-    cell->startcol  = startcol;
-    cell->pen       = NULL;
+    if (col < dirty->left)
+        dirty->left = col;
+    if (end > dirty->right)
+        dirty->right = end;
 }
 
 static RBCell *make_span(TickitRenderBuffer *rb, int line, int col, int cols) {
     int end        = col + cols;
     RBCell **cells = rb->cells;
 
+    mark_dirty(rb, line, col, end);
+
     // If the following cell is a CONT, it needs to become a new start
     if (end < rb->cols && cells[line][end].state == CONT) {
         int spanstart    = cells[line][end].cols;
@@ -207,17 +553,21 @@ static RBCell *make_span(TickitRenderBuffer *rb, int line, int col, int cols) {
                 endcell->state = SKIP;
                 endcell->cols  = afterlen;
                 break;
-            case TEXT:
-                endcell->state       = TEXT;
-                endcell->cols        = afterlen;
-                endcell->pen         = tickit_pen_ref(spancell->pen);
-                endcell->v.text.s    = tickit_string_ref(spancell->v.text.s);
-                endcell->v.text.offs = spancell->v.text.offs + end - spanstart;
-                break;
+            case TEXT: {
+                TickitStringPos pos;
+                size_t len;
+                const char *text = span_text_at(rb, spancell, 0, &len, &pos);
+                set_span_start(endcell, text, len, &pos, spancell->lead + end - spanstart);
+                endcell->v.text.bytes += spancell->v.text.bytes;
+
+                endcell->state = TEXT;
+                endcell->cols  = afterlen;
+                endcell->data  = spandata_ref(rb, spancell->data);
+            } break;
             case ERASE:
                 endcell->state = ERASE;
                 endcell->cols  = afterlen;
-                endcell->pen   = tickit_pen_ref(spancell->pen);
+                endcell->data  = spandata_ref(rb, spancell->data);
                 break;
             case LINE:
             case CHAR:
@@ -230,12 +580,17 @@ static RBCell *make_span(TickitRenderBuffer *rb, int line, int col, int cols) {
             cells[line][c].cols = end;
     }
 
+    // The first span wholly inside the range
+    int firstspan = col;
+
     // If the initial cell is a CONT, shorten its start
     if (cells[line][col].state == CONT) {
         int beforestart  = cells[line][col].cols;
         RBCell *spancell = &cells[line][beforestart];
         int beforelen    = col - beforestart;
 
+        firstspan = beforestart + spancell->cols;
+
         switch (spancell->state) {
             case SKIP:
             case TEXT:
@@ -249,70 +604,186 @@ static RBCell *make_span(TickitRenderBuffer *rb, int line, int col, int cols) {
         }
     }
 
-    // cont_cell() also frees any pens in the range
-    for (int c = col; c < end; c++)
-        cont_cell(&cells[line][c], col);
+    /* Release the spans being overwritten by stepping from one to the next,
+     * so a long span costs no more than a short one. A span split above
+     * still has its original length.
+     */
+    for (int c = firstspan; c < end; c += cells[line][c].cols)
+        release_span(rb, &cells[line][c]);
+
+    for (int c = col; c < end; c++) {
+        cells[line][c].state    = CONT;
+        cells[line][c].startcol = col;
+    }
 
     cells[line][col].cols = cols;
 
     return &cells[line][col];
 }
 
+static void masks_changed(TickitRenderBuffer *rb) {
+    if (++rb->mask_gen)
+        return;
+
+    // On wraparound, force every line to rebuild
+    if (rb->maskbits_gen)
+        memset(rb->maskbits_gen, 0, rb->lines * sizeof(unsigned int));
+    rb->mask_gen = 1;
+}
+
+// Returns the bitset of masked columns on the line; only valid while there
+//   are masks
+static const uint64_t *line_maskbits(TickitRenderBuffer *rb, int line) {
+    if (!rb->maskbits) {
+        rb->maskwords    = (rb->cols + 63) / 64;
+        rb->maskbits     = malloc(rb->lines * rb->maskwords * sizeof(uint64_t));
+        rb->maskbits_gen = calloc(rb->lines, sizeof(unsigned int));
+    }
+
+    uint64_t *bits = rb->maskbits + line * rb->maskwords;
+    if (rb->maskbits_gen[line] == rb->mask_gen)
+        return bits;
+
+    memset(bits, 0, rb->maskwords * sizeof(uint64_t));
+
+    for (int i = 0; i < rb->n_masks; i++) {
+        const TickitRect *hole = &rb->masks[i].rect;
+        if (line < hole->top || line >= tickit_rect_bottom(hole))
+            continue;
+
+        for (int col = hole->left; col < tickit_rect_right(hole); /**/) {
+            int bit = col % 64, n = 64 - bit;
+            if (n > tickit_rect_right(hole) - col)
+                n = tickit_rect_right(hole) - col;
+
+            bits[col / 64] |= (n == 64 ? ~UINT64_C(0) : ((UINT64_C(1) << n) - 1)) << bit;
+            col += n;
+        }
+    }
+
+    rb->maskbits_gen[line] = rb->mask_gen;
+    return bits;
+}
+
+static int ctz64(uint64_t word) {
+#ifdef __GNUC__
+    return __builtin_ctzll(word);
+#else
+    int n = 0;
+    while (!(word & 1)) {
+        word >>= 1;
+        n++;
+    }
+    return n;
+#endif
+}
+
+// Returns the first column from col up to end whose bit is set (or clear, if
+//   set is false), or end if there is none
+static int find_maskbit(const uint64_t *bits, int col, int end, bool set) {
+    while (col < end) {
+        uint64_t word = bits[col / 64];
+        if (!set)
+            word = ~word;
+        word >>= col % 64;
+
+        if (word) {
+            col += ctz64(word);
+            return col < end ? col : end;
+        }
+
+        col = (col / 64 + 1) * 64;
+    }
+
+    return end;
+}
+
+static bool is_masked(TickitRenderBuffer *rb, int line, int col) {
+    if (!rb->n_masks)
+        return false;
+
+    const uint64_t *bits = line_maskbits(rb, line);
+    return bits[col / 64] & (UINT64_C(1) << (col % 64));
+}
+
+// Advances *col past any masked columns, then returns the length of the run
+//   of unmasked columns starting there and stopping before end; 0 if none
+static int unmasked_run(TickitRenderBuffer *rb, int line, int *col, int end) {
+    if (*col >= end) {
+        *col = end;
+        return 0;
+    }
+
+    if (!rb->n_masks)
+        return end - *col;
+
+    const uint64_t *bits = line_maskbits(rb, line);
+
+    int start = find_maskbit(bits, *col, end, false);
+    *col      = start;
+    if (start >= end)
+        return 0;
+
+    return find_maskbit(bits, start, end, true) - start;
+}
+
 // cell creation functions
 
-static int put_string(TickitRenderBuffer *rb, int line, int col, TickitString *s) {
-    TickitStringPos endpos;
-    size_t len = tickit_utf8_ncount(tickit_string_get(s), tickit_string_len(s), &endpos, NULL);
-    if (1 + len == 0)
-        return -1;
+// Text is stored either by sharing s, by borrowing text, or else by copying
+//   text into the arena. If cols is not -1 it gives the width of the text,
+//   which then need not be counted
+static int put_string_or_text(TickitRenderBuffer *rb, int line, int col, TickitString *s,
+    const char *text, size_t len, int cols, bool borrow) {
+    if (cols == -1) {
+        TickitStringPos endpos;
+        if (1 + tickit_utf8_ncount(text, len, &endpos, NULL) == 0)
+            return -1;
 
-    int cols = endpos.columns;
-    int ret  = cols;
+        cols = endpos.columns;
+    }
+
+    int ret = cols;
 
     int startcol;
     if (!xlate_and_clip(rb, &line, &col, &cols, &startcol))
         return ret;
 
-    RBCell *linecells = rb->cells[line];
+    int end       = col + cols;
+    int origin    = col - startcol;  // where column 0 of the string would be
+    uint32_t data = s        ? spandata_new(rb, rb->pen, s)
+                    : borrow ? spandata_new_borrowed(rb, rb->pen, text, len)
+                             : spandata_new_text(rb, rb->pen, text, len);
 
-    while (cols) {
-        while (cols && linecells[col].maskdepth > -1) {
-            col++;
-            cols--;
-            startcol++;
-        }
-        if (!cols)
-            break;
+    // Count the stored copy; the arena may have moved when storing it
+    text = spandata_text(rb, data, &len);
 
-        int spanlen = 0;
-        while (cols && linecells[col + spanlen].maskdepth == -1) {
-            spanlen++;
-            cols--;
-        }
-        if (!spanlen)
-            break;
+    // Spans are created left to right, so the text only needs counting once
+    TickitStringPos pos;
+    tickit_stringpos_zero(&pos);
 
-        RBCell *cell      = make_span(rb, line, col, spanlen);
-        cell->state       = TEXT;
-        cell->pen         = tickit_pen_ref(rb->pen);
-        cell->v.text.s    = tickit_string_ref(s);
-        cell->v.text.offs = startcol;
+    int spanlen;
+    while ((spanlen = unmasked_run(rb, line, &col, end))) {
+        RBCell *cell = make_span(rb, line, col, spanlen);
+        cell->state  = TEXT;
+        cell->data   = spandata_ref(rb, data);
+        set_span_start(cell, text, len, &pos, col - origin);
 
         col += spanlen;
-        startcol += spanlen;
     }
 
+    spandata_unref(rb, data);
+
     return ret;
 }
 
-static int put_text(TickitRenderBuffer *rb, int line, int col, const char *text, size_t len) {
-    TickitString *s = tickit_string_new(text, len == -1 ? strlen(text) : len);
-
-    int ret = put_string(rb, line, col, s);
-
-    tickit_string_unref(s);
+static int put_string(TickitRenderBuffer *rb, int line, int col, TickitString *s) {
+    return put_string_or_text(
+        rb, line, col, s, tickit_string_get(s), tickit_string_len(s), -1, false);
+}
 
-    return ret;
+static int put_text(TickitRenderBuffer *rb, int line, int col, const char *text, size_t len) {
+    return put_string_or_text(
+        rb, line, col, NULL, text, len == -1 ? strlen(text) : len, -1, false);
 }
 
 static int put_vtextf(TickitRenderBuffer *rb, int line, int col, const char *fmt, va_list args) {
@@ -342,12 +813,13 @@ static void put_char(TickitRenderBuffer *rb, int line, int col, long codepoint)
     if (!xlate_and_clip(rb, &line, &col, &cols, NULL))
         return;
 
-    if (rb->cells[line][col].maskdepth > -1)
+    if (is_masked(rb, line, col))
         return;
 
+    uint32_t data         = spandata_new(rb, rb->pen, NULL);
     RBCell *cell          = make_span(rb, line, col, cols);
     cell->state           = CHAR;
-    cell->pen             = tickit_pen_ref(rb->pen);
+    cell->data            = data;
     cell->v.chr.codepoint = codepoint;
 }
 
@@ -355,24 +827,10 @@ static void skip(TickitRenderBuffer *rb, int line, int col, int cols) {
     if (!xlate_and_clip(rb, &line, &col, &cols, NULL))
         return;
 
-    RBCell *linecells = rb->cells[line];
-
-    while (cols) {
-        while (cols && linecells[col].maskdepth > -1) {
-            col++;
-            cols--;
-        }
-        if (!cols)
-            break;
-
-        int spanlen = 0;
-        while (cols && linecells[col + spanlen].maskdepth == -1) {
-            spanlen++;
-            cols--;
-        }
-        if (!spanlen)
-            break;
+    int end = col + cols;
 
+    int spanlen;
+    while ((spanlen = unmasked_run(rb, line, &col, end))) {
         RBCell *cell = make_span(rb, line, col, spanlen);
         cell->state  = SKIP;
 
@@ -384,30 +842,33 @@ static void erase(TickitRenderBuffer *rb, int line, int col, int cols) {
     if (!xlate_and_clip(rb, &line, &col, &cols, NULL))
         return;
 
-    RBCell *linecells = rb->cells[line];
-
-    while (cols) {
-        while (cols && linecells[col].maskdepth > -1) {
-            col++;
-            cols--;
-        }
-        if (!cols)
-            break;
-
-        int spanlen = 0;
-        while (cols && linecells[col + spanlen].maskdepth == -1) {
-            spanlen++;
-            cols--;
-        }
-        if (!spanlen)
-            break;
+    int end       = col + cols;
+    uint32_t data = spandata_new(rb, rb->pen, NULL);
 
+    int spanlen;
+    while ((spanlen = unmasked_run(rb, line, &col, end))) {
         RBCell *cell = make_span(rb, line, col, spanlen);
         cell->state  = ERASE;
-        cell->pen    = tickit_pen_ref(rb->pen);
+        cell->data   = spandata_ref(rb, data);
 
         col += spanlen;
     }
+
+    spandata_unref(rb, data);
+}
+
+static void init_blank(TickitRenderBuffer *rb) {
+    RBCell *linecells = rb->blank;
+    if (!rb->cols)
+        return;
+
+    linecells[0].state = SKIP;
+    linecells[0].cols  = rb->cols;
+
+    for (int col = 1; col < rb->cols; col++) {
+        linecells[col].state    = CONT;
+        linecells[col].startcol = 0;
+    }
 }
 
 TickitRenderBuffer *tickit_renderbuffer_new(int lines, int cols) {
@@ -416,21 +877,21 @@ TickitRenderBuffer *tickit_renderbuffer_new(int lines, int cols) {
     rb->lines = lines;
     rb->cols  = cols;
 
-    rb->cells = malloc(rb->lines * sizeof(RBCell *));
-    for (int line = 0; line < rb->lines; line++) {
-        rb->cells[line] = malloc(rb->cols * sizeof(RBCell));
+    // Lines are only allocated when first drawn to, so a tall buffer costs
+    //   little more than the lines actually used
+    rb->cells = calloc(rb->lines, sizeof(RBCell *));
 
-        rb->cells[line][0].state     = SKIP;
-        rb->cells[line][0].maskdepth = -1;
-        rb->cells[line][0].cols      = rb->cols;
-        rb->cells[line][0].pen       = NULL;
+    rb->blank = malloc(rb->cols * sizeof(RBCell));
+    init_blank(rb);
 
-        for (int col = 1; col < rb->cols; col++) {
-            rb->cells[line][col].state     = CONT;
-            rb->cells[line][col].maskdepth = -1;
-            rb->cells[line][col].cols      = 0;
-        }
-    }
+    rb->dirtymap = calloc((rb->lines + 63) / 64, sizeof(uint64_t));
+    rb->dirty    = malloc(rb->lines * sizeof(RBLineDirty));
+
+    rb->spandata_size = 64;  // will grow if required
+    rb->spandata      = malloc(rb->spandata_size * sizeof(RBSpanData));
+    rb->spandata_used = 0;
+    rb->spandata_free = 0;
+    rb->spandata_last = 0;
 
     rb->vc_pos_set = 0;
 
@@ -441,8 +902,26 @@ TickitRenderBuffer *tickit_renderbuffer_new(int lines, int cols) {
 
     rb->pen = tickit_pen_new();
 
-    rb->stack = NULL;
-    rb->depth = 0;
+    rb->size_stack = 16;  // will grow if required
+    rb->stack      = malloc(rb->size_stack * sizeof(RBStack));
+    rb->depth      = 0;
+
+    rb->size_masks = 16;  // will grow if required
+    rb->masks      = malloc(rb->size_masks * sizeof(RBMask));
+    rb->n_masks    = 0;
+
+    rb->maskbits     = NULL;
+    rb->maskwords    = 0;
+    rb->maskbits_gen = NULL;
+    rb->mask_gen     = 1;
+
+    for (int i = 0; i < PENCACHE_SIZE; i++)
+        rb->pencache[i].merged = NULL;
+    rb->pencache_next = 0;
+
+    rb->text     = NULL;  // allocated on first use
+    rb->textlen  = 0;
+    rb->textsize = 0;
 
     rb->tmpsize = 256;  // hopefully enough but will grow if required
     rb->tmp     = malloc(rb->tmpsize);
@@ -454,33 +933,33 @@ TickitRenderBuffer *tickit_renderbuffer_new(int lines, int cols) {
 }
 
 void tickit_renderbuffer_destroy(TickitRenderBuffer *rb) {
-    for (int line = 0; line < rb->lines; line++) {
-        for (int col = 0; col < rb->cols; col++) {
-            RBCell *cell = &rb->cells[line][col];
-            switch (cell->state) {
-                case TEXT:
-                    tickit_string_unref(cell->v.text.s);
-                    /* fallthrough */
-                case ERASE:
-                case LINE:
-                case CHAR:
-                    tickit_pen_unref(cell->pen);
-                    break;
-                case SKIP:
-                case CONT:
-                    break;
-            }
-        }
-        free(rb->cells[line]);
-    }
+    spandata_clear(rb);
+    free(rb->spandata);
 
+    for (int line = 0; line < rb->lines; line++)
+        free(rb->cells[line]);
     free(rb->cells);
     rb->cells = NULL;
 
+    free(rb->blank);
+
+    free(rb->dirtymap);
+    free(rb->dirty);
+
     tickit_pen_unref(rb->pen);
 
-    if (rb->stack)
-        free_stack(rb->stack);
+    clear_stack(rb);
+    free(rb->stack);
+
+    free(rb->masks);
+    free(rb->maskbits);
+    free(rb->maskbits_gen);
+
+    for (int i = 0; i < PENCACHE_SIZE; i++)
+        if (rb->pencache[i].merged)
+            tickit_pen_unref(rb->pencache[i].merged);
+
+    free(rb->text);
 
     free(rb->tmp);
 
@@ -548,13 +1027,24 @@ void tickit_renderbuffer_mask(TickitRenderBuffer *rb, TickitRect *mask) {
         hole.left = 0;
     }
 
-    for (int line = hole.top; line < tickit_rect_bottom(&hole) && line < rb->lines; line++) {
-        for (int col = hole.left; col < tickit_rect_right(&hole) && col < rb->cols; col++) {
-            RBCell *cell = &rb->cells[line][col];
-            if (cell->maskdepth == -1)
-                cell->maskdepth = rb->depth;
-        }
+    if (tickit_rect_bottom(&hole) > rb->lines)
+        hole.lines = rb->lines - hole.top;
+    if (tickit_rect_right(&hole) > rb->cols)
+        hole.cols = rb->cols - hole.left;
+
+    if (hole.lines <= 0 || hole.cols <= 0)
+        return;
+
+    if (rb->n_masks == rb->size_masks) {
+        rb->size_masks *= 2;
+        rb->masks = realloc(rb->masks, rb->size_masks * sizeof(RBMask));
     }
+
+    rb->masks[rb->n_masks++] = (RBMask){
+        .rect  = hole,
+        .depth = rb->depth,
+    };
+    masks_changed(rb);
 }
 
 bool tickit_renderbuffer_has_cursorpos(const TickitRenderBuffer *rb) { return rb->vc_pos_set; }
@@ -574,8 +1064,38 @@ void tickit_renderbuffer_goto(TickitRenderBuffer *rb, int line, int col) {
 
 void tickit_renderbuffer_ungoto(TickitRenderBuffer *rb) { rb->vc_pos_set = 0; }
 
-void tickit_renderbuffer_setpen(TickitRenderBuffer *rb, const TickitPen *pen) {
-    TickitPen *prevpen = rb->stack ? rb->stack->pen : NULL;
+// Whether merged has exactly the attributes that setpen would give it by
+//   merging pen over prevpen
+static bool pen_is_merge(const TickitPen *merged, const TickitPen *pen, const TickitPen *prevpen) {
+    for (TickitPenAttr attr = 1; attr < TICKIT_N_PEN_ATTRS; attr++) {
+        const TickitPen *src = NULL;
+        if (pen && tickit_pen_has_attr(pen, attr))
+            src = pen;
+        else if (prevpen && tickit_pen_has_attr(prevpen, attr))
+            src = prevpen;
+
+        if (!src) {
+            if (tickit_pen_has_attr(merged, attr))
+                return false;
+        } else if (!tickit_pen_has_attr(merged, attr) || !tickit_pen_equiv_attr(merged, src, attr))
+            return false;
+    }
+
+    return true;
+}
+
+// Returns a new reference to pen merged over prevpen
+static TickitPen *merge_pen(TickitRenderBuffer *rb, const TickitPen *pen, TickitPen *prevpen) {
+    /* Pens are never mutated inplace, so a merged pen can be shared. The
+     * caller may have changed its pen since it was cached though, so a hit
+     * still has to match.
+     */
+    for (int i = 0; i < PENCACHE_SIZE; i++) {
+        RBPenCacheEntry *entry = &rb->pencache[i];
+        if (entry->merged && entry->pen == pen && entry->prevpen == prevpen &&
+            pen_is_merge(entry->merged, pen, prevpen))
+            return tickit_pen_ref(entry->merged);
+    }
 
     /* never mutate the pen inplace; make a new one */
     TickitPen *newpen = tickit_pen_new();
@@ -585,21 +1105,32 @@ void tickit_renderbuffer_setpen(TickitRenderBuffer *rb, const TickitPen *pen) {
     if (prevpen)
         tickit_pen_copy(newpen, prevpen, 0);
 
-    tickit_pen_unref(rb->pen);
-    rb->pen = newpen;
+    RBPenCacheEntry *entry = &rb->pencache[rb->pencache_next];
+    rb->pencache_next      = (rb->pencache_next + 1) % PENCACHE_SIZE;
+
+    if (entry->merged)
+        tickit_pen_unref(entry->merged);
+    entry->pen     = pen;
+    entry->prevpen = prevpen;
+    entry->merged  = tickit_pen_ref(newpen);
+
+    return newpen;
 }
 
-void tickit_renderbuffer_reset(TickitRenderBuffer *rb) {
-    for (int line = 0; line < rb->lines; line++) {
-        // cont_cell also frees pen
-        for (int col = 0; col < rb->cols; col++)
-            cont_cell(&rb->cells[line][col], 0);
+void tickit_renderbuffer_setpen(TickitRenderBuffer *rb, const TickitPen *pen) {
+    TickitPen *prevpen = rb->depth ? rb->stack[rb->depth - 1].pen : NULL;
 
-        rb->cells[line][0].state     = SKIP;
-        rb->cells[line][0].maskdepth = -1;
-        rb->cells[line][0].cols      = rb->cols;
-    }
+    if (pen_is_merge(rb->pen, pen, prevpen))
+        return;
+
+    TickitPen *newpen = merge_pen(rb, pen, prevpen);
+
+    tickit_pen_unref(rb->pen);
+    rb->pen = newpen;
+}
 
+// Resets everything except the content
+static void reset_state(TickitRenderBuffer *rb) {
     rb->vc_pos_set = 0;
 
     rb->xlate_line = 0;
@@ -607,62 +1138,144 @@ void tickit_renderbuffer_reset(TickitRenderBuffer *rb) {
 
     tickit_rect_init_sized(&rb->clip, 0, 0, rb->lines, rb->cols);
 
-    tickit_pen_unref(rb->pen);
-    rb->pen = tickit_pen_new();
-
-    if (rb->stack) {
-        free_stack(rb->stack);
-        rb->stack = NULL;
-        rb->depth = 0;
+    // An empty pen can be kept; pens are never mutated inplace
+    if (tickit_pen_is_nonempty(rb->pen)) {
+        tickit_pen_unref(rb->pen);
+        rb->pen = tickit_pen_new();
     }
-}
 
-void tickit_renderbuffer_clear(TickitRenderBuffer *rb) {
-    DEBUG_LOGF(rb, "Bd", "Clear");
+    clear_stack(rb);
 
-    for (int line = 0; line < rb->lines; line++)
-        erase(rb, line, 0, rb->cols);
+    if (rb->n_masks) {
+        rb->n_masks = 0;
+        masks_changed(rb);
+    }
 }
 
-void tickit_renderbuffer_save(TickitRenderBuffer *rb) {
-    DEBUG_LOGF(rb, "Bs", "+-Save");
-
-    RBStack *stack = malloc(sizeof(struct RBStack));
+void tickit_renderbuffer_reset(TickitRenderBuffer *rb) {
+    // Every span is about to be discarded, so release all their pens and
+    //   strings together
+    spandata_clear(rb);
 
-    stack->vc_line    = rb->vc_line;
-    stack->vc_col     = rb->vc_col;
-    stack->xlate_line = rb->xlate_line;
-    stack->xlate_col  = rb->xlate_col;
-    stack->clip       = rb->clip;
-    stack->pen        = tickit_pen_ref(rb->pen);
-    stack->pen_only   = 0;
+    // Every line now reads as blank; their cells are left stale until drawn to
+    memset(rb->dirtymap, 0, (rb->lines + 63) / 64 * sizeof(uint64_t));
 
-    stack->prev = rb->stack;
-    rb->stack   = stack;
-    rb->depth++;
+    reset_state(rb);
 }
 
-void tickit_renderbuffer_savepen(TickitRenderBuffer *rb) {
-    DEBUG_LOGF(rb, "Bs", "+-Savepen");
+void tickit_renderbuffer_resize(TickitRenderBuffer *rb, int lines, int cols) {
+    if (lines == rb->lines && cols == rb->cols)
+        return;
 
-    RBStack *stack = malloc(sizeof(struct RBStack));
+    DEBUG_LOGF(rb, "Bd", "Resize to %dx%d", cols, lines);
+
+    // Lines beyond the new bottom are discarded
+    for (int line = lines; line < rb->lines; line++) {
+        if (line_is_dirty(rb, line))
+            for (int col = 0; col < rb->cols; col += rb->cells[line][col].cols)
+                release_span(rb, &rb->cells[line][col]);
+
+        free(rb->cells[line]);
+    }
+
+    int keptlines = lines < rb->lines ? lines : rb->lines;
+
+    for (int line = 0; line < keptlines; line++) {
+        bool dirty = line_is_dirty(rb, line);
+
+        // Spans beyond the new right edge are discarded, and any crossing it
+        //   truncated
+        if (dirty && cols < rb->cols) {
+            RBCell *cell = make_span(rb, line, cols, rb->cols - cols);
+            cell->state  = SKIP;
+
+            if (rb->dirty[line].right > cols)
+                rb->dirty[line].right = cols;
+            if (rb->dirty[line].left >= rb->dirty[line].right)
+                rb->dirtymap[line / 64] &= ~(UINT64_C(1) << (line % 64));
+        }
+
+        if (rb->cells[line] && cols != rb->cols)
+            rb->cells[line] = realloc(rb->cells[line], cols * sizeof(RBCell));
+
+        // New columns are skipping
+        if (dirty && cols > rb->cols) {
+            RBCell *linecells = rb->cells[line];
+
+            linecells[rb->cols].state = SKIP;
+            linecells[rb->cols].cols  = cols - rb->cols;
+
+            for (int col = rb->cols + 1; col < cols; col++) {
+                linecells[col].state    = CONT;
+                linecells[col].startcol = rb->cols;
+            }
+        }
+    }
+
+    rb->cells = realloc(rb->cells, lines * sizeof(RBCell *));
+    for (int line = rb->lines; line < lines; line++)
+        rb->cells[line] = NULL;
+
+    int oldwords = (rb->lines + 63) / 64, words = (lines + 63) / 64;
+    rb->dirtymap = realloc(rb->dirtymap, words * sizeof(uint64_t));
+    for (int i = oldwords; i < words; i++)
+        rb->dirtymap[i] = 0;
+    if (lines < rb->lines && lines % 64)
+        rb->dirtymap[lines / 64] &= (UINT64_C(1) << (lines % 64)) - 1;
+
+    rb->dirty = realloc(rb->dirty, lines * sizeof(RBLineDirty));
+
+    // Rebuilt at the new size on next use
+    free(rb->maskbits);
+    free(rb->maskbits_gen);
+    rb->maskbits     = NULL;
+    rb->maskwords    = 0;
+    rb->maskbits_gen = NULL;
+
+    rb->lines = lines;
+    rb->cols  = cols;
+
+    rb->blank = realloc(rb->blank, cols * sizeof(RBCell));
+    init_blank(rb);
+
+    reset_state(rb);
+}
+
+void tickit_renderbuffer_clear(TickitRenderBuffer *rb) {
+    DEBUG_LOGF(rb, "Bd", "Clear");
+
+    for (int line = 0; line < rb->lines; line++)
+        erase(rb, line, 0, rb->cols);
+}
+
+void tickit_renderbuffer_save(TickitRenderBuffer *rb) {
+    DEBUG_LOGF(rb, "Bs", "+-Save");
+
+    RBStack *stack = push_stack(rb);
+
+    stack->vc_line    = rb->vc_line;
+    stack->vc_col     = rb->vc_col;
+    stack->xlate_line = rb->xlate_line;
+    stack->xlate_col  = rb->xlate_col;
+    stack->clip       = rb->clip;
+    stack->pen        = tickit_pen_ref(rb->pen);
+    stack->pen_only   = 0;
+}
+
+void tickit_renderbuffer_savepen(TickitRenderBuffer *rb) {
+    DEBUG_LOGF(rb, "Bs", "+-Savepen");
+
+    RBStack *stack = push_stack(rb);
 
     stack->pen      = tickit_pen_ref(rb->pen);
     stack->pen_only = 1;
-
-    stack->prev = rb->stack;
-    rb->stack   = stack;
-    rb->depth++;
 }
 
 void tickit_renderbuffer_restore(TickitRenderBuffer *rb) {
-    RBStack *stack;
-
-    if (!rb->stack)
+    if (!rb->depth)
         return;
 
-    stack     = rb->stack;
-    rb->stack = stack->prev;
+    RBStack *stack = &rb->stack[--rb->depth];
 
     if (!stack->pen_only) {
         rb->vc_line    = stack->vc_line;
@@ -677,15 +1290,11 @@ void tickit_renderbuffer_restore(TickitRenderBuffer *rb) {
     // We've now definitely taken ownership of the old stack frame's pen, so
     //   it doesn't need destroying now
 
-    rb->depth--;
-
-    // TODO: this could be done more efficiently by remembering the edges of masking
-    for (int line = 0; line < rb->lines; line++)
-        for (int col = 0; col < rb->cols; col++)
-            if (rb->cells[line][col].maskdepth > rb->depth)
-                rb->cells[line][col].maskdepth = -1;
-
-    free(stack);
+    if (rb->n_masks && rb->masks[rb->n_masks - 1].depth > rb->depth) {
+        while (rb->n_masks && rb->masks[rb->n_masks - 1].depth > rb->depth)
+            rb->n_masks--;
+        masks_changed(rb);
+    }
 
     DEBUG_LOGF(rb, "Bs", "+-Restore");
 }
@@ -739,6 +1348,16 @@ int tickit_renderbuffer_textn_at(
     return cols;
 }
 
+int tickit_renderbuffer_textn_borrowed_at(
+    TickitRenderBuffer *rb, int line, int col, const char *text, size_t len, int cols) {
+    cols = put_string_or_text(
+        rb, line, col, NULL, text, len == -1 ? strlen(text) : len, cols, true);
+
+    DEBUG_LOGF(rb, "Bd", "Text (%d..%d,%d)", col, col + cols, line);
+
+    return cols;
+}
+
 int tickit_renderbuffer_text(TickitRenderBuffer *rb, const char *text) {
     return tickit_renderbuffer_textn(rb, text, -1);
 }
@@ -755,6 +1374,20 @@ int tickit_renderbuffer_textn(TickitRenderBuffer *rb, const char *text, size_t l
     return cols;
 }
 
+int tickit_renderbuffer_textn_borrowed(
+    TickitRenderBuffer *rb, const char *text, size_t len, int cols) {
+    if (!rb->vc_pos_set)
+        return -1;
+
+    cols = put_string_or_text(
+        rb, rb->vc_line, rb->vc_col, NULL, text, len == -1 ? strlen(text) : len, cols, true);
+
+    DEBUG_LOGF(rb, "Bd", "Text (%d..%d,%d) +%d", rb->vc_col, rb->vc_col + cols, rb->vc_line, cols);
+
+    rb->vc_col += cols;
+    return cols;
+}
+
 int tickit_renderbuffer_textf_at(TickitRenderBuffer *rb, int line, int col, const char *fmt, ...) {
     va_list args;
     va_start(args, fmt);
@@ -857,24 +1490,160 @@ static void linecell(TickitRenderBuffer *rb, int line, int col, int bits) {
     if (!xlate_and_clip(rb, &line, &col, &cols, NULL))
         return;
 
-    if (rb->cells[line][col].maskdepth > -1)
+    if (is_masked(rb, line, col))
         return;
 
-    RBCell *cell = &rb->cells[line][col];
+    RBCell *cell = &line_cells(rb, line)[col];
     if (cell->state != LINE) {
-        make_span(rb, line, col, cols);
+        cell              = make_span(rb, line, col, cols);
         cell->state       = LINE;
         cell->cols        = 1;
-        cell->pen         = tickit_pen_ref(rb->pen);
+        cell->data        = spandata_new(rb, rb->pen, NULL);
         cell->v.line.mask = 0;
-    } else if (!tickit_pen_equiv(cell->pen, rb->pen)) {
-        tickit_pen_unref(cell->pen);
-        cell->pen = tickit_pen_ref(rb->pen);
+    } else if (!tickit_pen_equiv(cell_pen(rb, cell), rb->pen)) {
+        uint32_t data = spandata_new(rb, rb->pen, NULL);
+        spandata_unref(rb, cell->data);
+        cell->data = data;
     }
 
     cell->v.line.mask |= bits;
 }
 
+void tickit_renderbuffer_draw_ops(
+    TickitRenderBuffer *rb, const TickitRenderBufferOp *ops, size_t n) {
+    DEBUG_LOGF(rb, "Bd", "Draw %zu ops", n);
+
+    /* Each op's pen is merged over the current one, as if drawn inside a
+     * savepen/setpen/restore; but without pushing the stack for each op.
+     * Runs of ops sharing a pen share one merge.
+     */
+    TickitPen *basepen = rb->pen;
+    const TickitPen *oppen = NULL;
+    TickitPen *merged      = NULL;
+
+    for (size_t i = 0; i < n; i++) {
+        const TickitRenderBufferOp *op = &ops[i];
+
+        if (!op->pen)
+            rb->pen = basepen;
+        else {
+            if (!merged || op->pen != oppen) {
+                if (merged)
+                    tickit_pen_unref(merged);
+                oppen  = op->pen;
+                merged = merge_pen(rb, oppen, basepen);
+            }
+            rb->pen = merged;
+        }
+
+        switch (op->type) {
+            case TICKIT_RENDERBUFFER_OP_TEXT: {
+                size_t len = op->v.text.len;
+                put_text(rb, op->line, op->col, op->v.text.str,
+                    len == -1 ? strlen(op->v.text.str) : len);
+            } break;
+            case TICKIT_RENDERBUFFER_OP_ERASE:
+                erase(rb, op->line, op->col, op->v.cols);
+                break;
+            case TICKIT_RENDERBUFFER_OP_CHAR:
+                put_char(rb, op->line, op->col, op->v.codepoint);
+                break;
+            case TICKIT_RENDERBUFFER_OP_SKIP:
+                skip(rb, op->line, op->col, op->v.cols);
+                break;
+        }
+    }
+
+    rb->pen = basepen;
+    if (merged)
+        tickit_pen_unref(merged);
+}
+
+// The number of cells from cells[i] onwards that it covers as a glyph of its
+//   own in a string; 1 for a narrow character, 2 for a wide one followed by a
+//   zero placeholder, or 0 if it wouldn't line up with the grid that way
+static int cell_glyph_cols(const TickitRenderBufferCell *cells, size_t i, size_t n) {
+    long codepoint = cells[i].codepoint;
+    if (codepoint >= 0x20 && codepoint < 0x7f)
+        return 1;
+
+    char buf[6];
+    size_t len = tickit_utf8_put(buf, sizeof buf, codepoint);
+    if (len == (size_t)-1)
+        return 0;
+
+    TickitStringPos pos;
+    if (tickit_utf8_ncount(buf, len, &pos, NULL) == (size_t)-1)
+        return 0;
+
+    if (pos.columns == 1)
+        return 1;
+    if (pos.columns == 2 && i + 1 < n && !cells[i + 1].codepoint)
+        return 2;
+    return 0;
+}
+
+void tickit_renderbuffer_put_cells(TickitRenderBuffer *rb, int line, int col,
+    const TickitRenderBufferCell *cells, size_t n, const TickitPen **palette) {
+    DEBUG_LOGF(rb, "Bd", "Cells (%d..%d,%d)", col, col + (int)n, line);
+
+    TickitPen *basepen = rb->pen;
+    int mergedidx      = -1;
+    TickitPen *merged  = NULL;
+
+    for (size_t i = 0; i < n; /**/) {
+        if (!cells[i].codepoint) {
+            i++;
+            continue;
+        }
+
+        int pen = palette ? cells[i].pen : -1;
+
+        if (pen < 0)
+            rb->pen = basepen;
+        else {
+            if (pen != mergedidx) {
+                if (merged)
+                    tickit_pen_unref(merged);
+                mergedidx = pen;
+                merged    = merge_pen(rb, palette[pen], basepen);
+            }
+            rb->pen = merged;
+        }
+
+        /* Anything that would not line up with the grid if it were counted
+         * as part of a string, such as a combining mark, is placed just as
+         * char_at would
+         */
+        if (!cell_glyph_cols(cells, i, n)) {
+            put_char(rb, line, col + i, cells[i].codepoint);
+            i++;
+            continue;
+        }
+
+        /* Otherwise each run of cells sharing a pen becomes one TEXT span, so
+         * there is only one copy of its text and one span data for the run
+         */
+        size_t start = i;
+        int glyphcols;
+
+        rb->tmplen = 0;
+        while (i < n && cells[i].codepoint && (palette ? cells[i].pen : -1) == pen &&
+               (glyphcols = cell_glyph_cols(cells, i, n))) {
+            char buf[6];
+            tmp_cat(rb, buf, tickit_utf8_put(buf, sizeof buf, cells[i].codepoint));
+            i += glyphcols;
+        }
+
+        put_string_or_text(rb, line, col + start, NULL, rb->tmp, rb->tmplen, i - start, false);
+    }
+
+    rb->tmplen = 0;
+    rb->pen    = basepen;
+    if (merged)
+        tickit_pen_unref(merged);
+}
+
 void tickit_renderbuffer_hline_at(TickitRenderBuffer *rb, int line, int startcol, int endcol,
     TickitLineStyle style, TickitLineCaps caps) {
     DEBUG_LOGF(rb, "Bd", "HLine (%d..%d,%d)", startcol, endcol, line);
@@ -901,13 +1670,70 @@ void tickit_renderbuffer_vline_at(TickitRenderBuffer *rb, int startline, int end
     linecell(rb, endline, col, (caps & TICKIT_LINECAP_END ? south : 0) | north);
 }
 
-void tickit_renderbuffer_flush_to_term(TickitRenderBuffer *rb, TickitTerm *tt) {
-    DEBUG_LOGF(rb, "Bf", "Flush to term");
+static inline bool pen_equiv(const TickitPen *a, const TickitPen *b) {
+    return a == b || tickit_pen_equiv(a, b);
+}
 
-    for (int line = 0; line < rb->lines; line++) {
+// Where the content of a buffer is sent to by output_spans(). Consecutive
+//   calls to print always continue the same run of text
+typedef struct {
+    void (*goto_abs)(void *ctx, int line, int col);
+    void (*setpen)(void *ctx, const TickitPen *pen);
+    void (*print)(void *ctx, const char *str, size_t len);
+    void (*erasech)(void *ctx, int count, TickitMaybeBool moveend);
+} RBOutput;
+
+// Prints the text a TEXT, LINE or CHAR span displays
+static void output_span_text(
+    const TickitRenderBuffer *rb, const RBCell *cell, const RBOutput *out, void *ctx) {
+    char buf[6];
+    size_t len;
+
+    switch (cell->state) {
+        case TEXT: {
+            TickitStringPos start, end, limit;
+            const char *text = span_text_at(rb, cell, 0, &len, &start);
+
+            tickit_stringpos_limit_columns(&limit, cell->lead + cell->cols);
+            end = start;
+            tickit_utf8_ncountmore(text, len, &end, &limit);
+
+            (*out->print)(ctx, text + start.bytes, end.bytes - start.bytes);
+        } break;
+        case LINE:
+            len = tickit_utf8_put(buf, sizeof buf, linemask_to_char[cell->v.line.mask]);
+            (*out->print)(ctx, buf, len);
+            break;
+        case CHAR:
+            len = tickit_utf8_put(buf, sizeof buf, cell->v.chr.codepoint);
+            (*out->print)(ctx, buf, len);
+            break;
+        case SKIP:
+        case ERASE:
+        case CONT:
+            /* unreachable */
+            abort();
+    }
+}
+
+// Only reads the buffer, so several ranges of one buffer may be output at
+//   once on different threads
+static void output_spans(
+    const TickitRenderBuffer *rb, int startline, int endline, const RBOutput *out, void *ctx) {
+    /* The pen most recently given to the output; within one flush nothing
+     * else changes it, so it need only be set again when the pen differs
+     */
+    TickitPen *outpen = NULL;
+
+    /* Anything outside of the dirty columns is skipping, so that is all that
+     * needs looking at
+     */
+    for (int line = next_dirty_line(rb, startline); line < endline;
+         line      = next_dirty_line(rb, line + 1)) {
         int phycol = -1; /* column where the terminal cursor physically is */
+        int right  = rb->dirty[line].right;
 
-        for (int col = 0; col < rb->cols; /**/) {
+        for (int col = rb->dirty[line].left; col < right; /**/) {
             RBCell *cell = &rb->cells[line][col];
 
             if (cell->state == SKIP) {
@@ -916,76 +1742,552 @@ void tickit_renderbuffer_flush_to_term(TickitRenderBuffer *rb, TickitTerm *tt) {
             }
 
             if (phycol < col)
-                tickit_term_goto(tt, line, col);
+                (*out->goto_abs)(ctx, line, col);
             phycol = col;
 
-            switch (cell->state) {
-                case TEXT: {
-                    TickitStringPos start, end, limit;
-                    const char *text = tickit_string_get(cell->v.text.s);
-
-                    tickit_stringpos_limit_columns(&limit, cell->v.text.offs);
-                    tickit_utf8_count(text, &start, &limit);
+            TickitPen *pen = cell_pen(rb, cell);
+            if (!outpen || !pen_equiv(pen, outpen)) {
+                (*out->setpen)(ctx, pen);
+                outpen = pen;
+            }
 
-                    limit.columns += cell->cols;
-                    end = start;
-                    tickit_utf8_countmore(text, &end, &limit);
+            if (cell->state == ERASE) {
+                /* No need to set moveend=true to erasech unless we actually
+                 * have more content */
+                int moveend = col + cell->cols < rb->cols &&
+                              rb->cells[line][col + cell->cols].state != SKIP;
 
-                    tickit_term_setpen(tt, cell->pen);
-                    tickit_term_printn(tt, text + start.bytes, end.bytes - start.bytes);
+                (*out->erasech)(ctx, cell->cols, moveend ? TICKIT_YES : TICKIT_MAYBE);
 
+                if (moveend)
                     phycol += cell->cols;
-                } break;
-                case ERASE: {
-                    /* No need to set moveend=true to erasech unless we actually
-                     * have more content */
-                    int moveend = col + cell->cols < rb->cols &&
-                                  rb->cells[line][col + cell->cols].state != SKIP;
-
-                    tickit_term_setpen(tt, cell->pen);
-                    tickit_term_erasech(tt, cell->cols, moveend ? TICKIT_YES : TICKIT_MAYBE);
-
-                    if (moveend)
-                        phycol += cell->cols;
-                    else
-                        phycol = -1;
-                } break;
-                case LINE: {
-                    TickitPen *pen = cell->pen;
-
-                    do {
-                        tmp_cat_utf8(rb, linemask_to_char[cell->v.line.mask]);
-
-                        col++;
-                        phycol += cell->cols;
-                    } while (col < rb->cols && (cell = &rb->cells[line][col]) &&
-                             cell->state == LINE && tickit_pen_equiv(cell->pen, pen));
-
-                    tickit_term_setpen(tt, pen);
-                    tickit_term_printn(tt, rb->tmp, rb->tmplen);
-                    rb->tmplen = 0;
+                else
+                    phycol = -1;
+
+                col += cell->cols;
+                continue;
+            }
+
+            /* The longest run of printing spans that share a pen is output
+             * as one run of text
+             */
+            do {
+                output_span_text(rb, cell, out, ctx);
+
+                col += cell->cols;
+                phycol += cell->cols;
+            } while (col < right && (cell = &rb->cells[line][col]) &&
+                     (cell->state == TEXT || cell->state == LINE || cell->state == CHAR) &&
+                     pen_equiv(cell_pen(rb, cell), pen));
+        }
+    }
+}
+
+typedef struct {
+    TickitRenderBuffer *rb;  // rb->tmp collects a run of text to print at once
+    TickitTerm *tt;
+} RBTermOutput;
+
+static void term_flush_print(RBTermOutput *out) {
+    TickitRenderBuffer *rb = out->rb;
+    if (!rb->tmplen)
+        return;
+
+    tickit_term_printn(out->tt, rb->tmp, rb->tmplen);
+    rb->tmplen = 0;
+}
+
+static void term_goto_abs(void *ctx, int line, int col) {
+    term_flush_print(ctx);
+    tickit_term_goto(((RBTermOutput *)ctx)->tt, line, col);
+}
+
+static void term_setpen(void *ctx, const TickitPen *pen) {
+    term_flush_print(ctx);
+    tickit_term_setpen(((RBTermOutput *)ctx)->tt, pen);
+}
+
+static void term_print(void *ctx, const char *str, size_t len) {
+    tmp_cat(((RBTermOutput *)ctx)->rb, str, len);
+}
+
+static void term_erasech(void *ctx, int count, TickitMaybeBool moveend) {
+    term_flush_print(ctx);
+    tickit_term_erasech(((RBTermOutput *)ctx)->tt, count, moveend);
+}
+
+static const RBOutput term_output = {
+    .goto_abs = &term_goto_abs,
+    .setpen   = &term_setpen,
+    .print    = &term_print,
+    .erasech  = &term_erasech,
+};
+
+void tickit_renderbuffer_flush_to_term(TickitRenderBuffer *rb, TickitTerm *tt) {
+    DEBUG_LOGF(rb, "Bf", "Flush to term");
+
+    RBTermOutput out = {.rb = rb, .tt = tt};
+    output_spans(rb, 0, rb->lines, &term_output, &out);
+    term_flush_print(&out);
+
+    tickit_renderbuffer_reset(rb);
+}
+
+typedef struct {
+    const struct TickitRenderBufferEncodeProfile *profile;
+    char *buf;
+    size_t size;  // of buf
+    size_t len;   // total output; may exceed size
+    TickitPen *pen, *delta;
+} RBEncoder;
+
+static void enc_write(RBEncoder *enc, const char *str, size_t len) {
+    if (enc->len < enc->size)
+        memcpy(enc->buf + enc->len, str, enc->len + len > enc->size ? enc->size - enc->len : len);
+    enc->len += len;
+}
+
+static void enc_writef(RBEncoder *enc, const char *fmt, ...) {
+    char buffer[32];  // enough for any CSI sequence we write
+
+    va_list args;
+    va_start(args, fmt);
+    int len = vsnprintf(buffer, sizeof buffer, fmt, args);
+    va_end(args);
+
+    enc_write(enc, buffer, len);
+}
+
+static void enc_goto_abs(void *ctx, int line, int col) {
+    if (col > 0)
+        enc_writef(ctx, "\e[%d;%dH", line + 1, col + 1);
+    else
+        enc_writef(ctx, "\e[%dH", line + 1);
+}
+
+static void enc_setpen(void *ctx, const TickitPen *pen) {
+    RBEncoder *enc = ctx;
+
+    // The terminal's initial pen is unknown, so start from a clean one
+    if (!enc->pen) {
+        enc_write(enc, "\e[m", 3);
+        enc->pen   = tickit_pen_new();
+        enc->delta = tickit_pen_new();
+    }
+
+    tickit_pen_clear(enc->delta);
+    for (TickitPenAttr attr = 1; attr < TICKIT_N_PEN_ATTRS; attr++) {
+        if (tickit_pen_equiv_attr(enc->pen, pen, attr))
+            continue;
+
+        tickit_pen_copy_attr(enc->pen, pen, attr);
+        tickit_pen_copy_attr(enc->delta, pen, attr);
+    }
+
+    char buffer[XTERM_SGR_MAXLEN];
+    size_t len = tickit_termdrv_xterm_sgr(buffer, enc->delta, enc->pen,
+        enc->profile && enc->profile->rgb8, enc->profile && enc->profile->csi_sub_colon);
+    enc_write(enc, buffer, len);
+}
+
+static void enc_print(void *ctx, const char *str, size_t len) { enc_write(ctx, str, len); }
+
+static void enc_erasech(void *ctx, int count, TickitMaybeBool moveend) {
+    RBEncoder *enc = ctx;
+
+    /* As for the xterm driver; ECH doesn't erase in reverse-video properly,
+     * so write spaces instead
+     */
+    if (!tickit_pen_get_bool_attr(enc->pen, TICKIT_PEN_REVERSE)) {
+        if (count == 1)
+            enc_write(enc, "\e[X", 3);
+        else
+            enc_writef(enc, "\e[%dX", count);
+
+        if (moveend == TICKIT_YES && count == 1)
+            enc_write(enc, "\e[C", 3);
+        else if (moveend == TICKIT_YES)
+            enc_writef(enc, "\e[%dC", count);
+    } else {
+        static const char spaces[] = "                                ";
+        while (count > 0) {
+            int n = count < sizeof spaces - 1 ? count : sizeof spaces - 1;
+            enc_write(enc, spaces, n);
+            count -= n;
+        }
+    }
+}
+
+static const RBOutput enc_output = {
+    .goto_abs = &enc_goto_abs,
+    .setpen   = &enc_setpen,
+    .print    = &enc_print,
+    .erasech  = &enc_erasech,
+};
+
+size_t tickit_renderbuffer_encode(TickitRenderBuffer *rb,
+    const struct TickitRenderBufferEncodeProfile *profile, char *buffer, size_t len) {
+    DEBUG_LOGF(rb, "Bf", "Encode to buffer");
+
+    return tickit_renderbuffer_encode_lines(rb, profile, 0, rb->lines, buffer, len);
+}
+
+size_t tickit_renderbuffer_encode_lines(TickitRenderBuffer *rb,
+    const struct TickitRenderBufferEncodeProfile *profile, int startline, int endline,
+    char *buffer, size_t len) {
+    if (startline < 0)
+        startline = 0;
+    if (endline > rb->lines)
+        endline = rb->lines;
+
+    RBEncoder enc = {
+        .profile = profile,
+        .buf     = buffer,
+        .size    = buffer ? len : 0,
+    };
+
+    output_spans(rb, startline, endline, &enc_output, &enc);
+
+    if (enc.pen) {
+        tickit_pen_unref(enc.pen);
+        tickit_pen_unref(enc.delta);
+    }
+
+    return enc.len;
+}
+
+// A single displayed glyph (or erased column) as the terminal would show it
+typedef struct {
+    enum TickitRenderBufferCellState state;
+    int cols;
+    TickitPen *pen;
+    const char *bytes;  // NULL if this glyph can never compare equal
+    size_t len;
+    char buf[6];
+} RBGlyph;
+
+// Remembers the string position within the most recent TEXT span, so walking
+//   a span glyph by glyph doesn't have to recount it from the start each time
+typedef struct {
+    TickitRenderBuffer *rb;
+    int line;
+    int spanstart;
+    TickitStringPos pos;
+} RBGlyphIter;
+
+static void get_glyph(RBGlyphIter *iter, int col, RBGlyph *glyph) {
+    RBCell *linecells = line_cells(iter->rb, iter->line);
+
+    int spanstart = linecells[col].state == CONT ? linecells[col].startcol : col;
+    RBCell *span  = &linecells[spanstart];
+    int offset    = col - spanstart;
+
+    glyph->state = span->state;
+    glyph->pen   = span->state == SKIP ? NULL : cell_pen(iter->rb, span);
+    glyph->bytes = glyph->buf;
+    glyph->len   = 0;
+
+    switch (span->state) {
+        case SKIP:
+            glyph->cols = span->cols - offset;
+            return;
+        case ERASE:
+            glyph->cols = 1;
+            return;
+        case LINE:
+            glyph->cols = 1;
+            glyph->len  = tickit_utf8_put(glyph->buf, sizeof glyph->buf,
+                linemask_to_char[span->v.line.mask]);
+            return;
+        case CHAR:
+            glyph->cols = 1;
+            glyph->len  = tickit_utf8_put(glyph->buf, sizeof glyph->buf, span->v.chr.codepoint);
+            return;
+        case TEXT:
+            break;
+        case CONT:
+            /* unreachable */
+            abort();
+    }
+
+    size_t len;
+    const char *text = cell_text(iter->rb, span, &len);
+    int target       = span->lead + offset;
+
+    text += span->v.text.bytes;
+    len -= span->v.text.bytes;
+
+    if (iter->spanstart != spanstart || iter->pos.columns > target) {
+        iter->spanstart = spanstart;
+        tickit_stringpos_zero(&iter->pos);
+    }
+
+    TickitStringPos limit;
+    tickit_stringpos_limit_columns(&limit, target);
+    tickit_utf8_ncountmore(text, len, &iter->pos, &limit);
+
+    TickitStringPos end = iter->pos;
+    tickit_stringpos_limit_graphemes(&limit, iter->pos.graphemes + 1);
+    tickit_utf8_ncountmore(text, len, &end, &limit);
+
+    glyph->cols  = end.columns - target;
+    glyph->bytes = text + iter->pos.bytes;
+    glyph->len   = end.bytes - iter->pos.bytes;
+
+    // Half of a wide character, or one cut off by the span end
+    if (iter->pos.columns != target || glyph->cols > span->cols - offset || glyph->cols < 1) {
+        if (glyph->cols < 1 || glyph->cols > span->cols - offset)
+            glyph->cols = 1;
+        glyph->bytes = NULL;
+    }
+}
+
+static bool glyph_equiv(const RBGlyph *a, const RBGlyph *b) {
+    if (a->state == SKIP || b->state == SKIP)
+        return false;
+    if ((a->state == ERASE) != (b->state == ERASE))
+        return false;
+    if (a->cols != b->cols)
+        return false;
+    if (!a->bytes || !b->bytes || a->len != b->len || memcmp(a->bytes, b->bytes, a->len))
+        return false;
+
+    return tickit_pen_equiv(a->pen, b->pen);
+}
+
+// Copies a span cell directly, without recounting text or replaying the pen
+static void copy_span(
+    TickitRenderBuffer *dst, int line, int col, TickitRenderBuffer *src, const RBCell *srccell) {
+    RBSpanData *srcdata = &src->spandata[srccell->data];
+
+    uint32_t data;
+    if (srccell->state == TEXT && srcdata->text != SPANTEXT_SHARED) {
+        // The source arena won't outlive its next reset, and the destination
+        //   may never be reset; so keep the text in a string of its own,
+        //   unless it is small enough to keep in the entry
+        size_t len;
+        const char *text = cell_text(src, srccell, &len);
+        if (len <= SMALLTEXT_MAX)
+            data = spandata_new_text(dst, srcdata->pen, text, len);
+        else {
+            TickitString *s = tickit_string_new(text, len);
+            data            = spandata_new(dst, srcdata->pen, s);
+            tickit_string_unref(s);
+        }
+    } else
+        data = spandata_new(dst, srcdata->pen, srcdata->s);
+
+    RBCell *cell = make_span(dst, line, col, srccell->cols);
+    cell->state  = srccell->state;
+    cell->lead   = srccell->lead;
+    cell->data   = data;
+    cell->v      = srccell->v;
+}
+
+/* INTERNAL */
+void tickit_renderbuffer_diff(TickitRenderBuffer *rb, TickitRenderBuffer *front) {
+    DEBUG_LOGF(rb, "Bf", "Diff against front buffer");
+
+    int lines = rb->lines < front->lines ? rb->lines : front->lines;
+    int cols  = rb->cols < front->cols ? rb->cols : front->cols;
+
+    // start/end pairs of unchanged runs on the current line
+    int unchanged[cols + 1];
+
+    for (int line = 0; line < lines; line++) {
+        // An undrawn line is all skipping; nothing to compare or copy
+        if (!line_is_dirty(rb, line))
+            continue;
+
+        RBGlyphIter backiter  = {.rb = rb, .line = line, .spanstart = -1};
+        RBGlyphIter frontiter = {.rb = front, .line = line, .spanstart = -1};
+        int n_unchanged       = 0;
+
+        for (int col = 0; col < cols; /**/) {
+            RBGlyph back, fore;
+            get_glyph(&backiter, col, &back);
+
+            if (back.state != SKIP && col + back.cols <= cols) {
+                get_glyph(&frontiter, col, &fore);
+
+                if (glyph_equiv(&back, &fore)) {
+                    if (n_unchanged && unchanged[n_unchanged - 1] == col)
+                        unchanged[n_unchanged - 1] = col + back.cols;
+                    else {
+                        unchanged[n_unchanged++] = col;
+                        unchanged[n_unchanged++] = col + back.cols;
+                    }
                 }
-                    continue; /* col already updated */
-                case CHAR: {
-                    tmp_cat_utf8(rb, cell->v.chr.codepoint);
+            }
 
-                    tickit_term_setpen(tt, cell->pen);
-                    tickit_term_printn(tt, rb->tmp, rb->tmplen);
-                    rb->tmplen = 0;
+            col += back.cols;
+        }
 
-                    phycol += cell->cols;
-                } break;
-                case SKIP:
-                case CONT:
-                    /* unreachable */
-                    abort();
+        for (int i = 0; i < n_unchanged; i += 2) {
+            RBCell *cell = make_span(rb, line, unchanged[i], unchanged[i + 1] - unchanged[i]);
+            cell->state  = SKIP;
+        }
+
+        RBCell *linecells = line_cells(rb, line);
+        for (int col = 0; col < cols; col += linecells[col].cols) {
+            RBCell *cell = &linecells[col];
+            if (cell->state == SKIP)
+                continue;
+
+            if (col + cell->cols > cols) {
+                // Can't know what the terminal will show past the front's edge
+                RBCell *skipped = make_span(front, line, col, cols - col);
+                skipped->state  = SKIP;
+                break;
             }
 
-            col += cell->cols;
+            copy_span(front, line, col, rb, cell);
         }
     }
+}
 
-    tickit_renderbuffer_reset(rb);
+// Draws cols columns of a span of src, starting offset columns into it, into
+//   dst at the given position, as the drawing function that made it would
+static void redraw_span(TickitRenderBuffer *dst, TickitRenderBuffer *src, const RBCell *cell,
+    int offset, int cols, int line, int col, bool copy_skip) {
+    if (cell->state != SKIP) {
+        tickit_renderbuffer_savepen(dst);
+        tickit_renderbuffer_setpen(dst, cell_pen(src, cell));
+    }
+
+    switch (cell->state) {
+        case SKIP:
+            if (copy_skip)
+                skip(dst, line, col, cols);
+            break;
+        case TEXT: {
+            TickitStringPos start, end, limit;
+            size_t len;
+            const char *text = span_text_at(src, cell, offset, &len, &start);
+            RBSpanData *data = &src->spandata[cell->data];
+            TickitString *s  = data->text == SPANTEXT_SHARED ? data->s : NULL;
+
+            tickit_stringpos_limit_columns(&limit, cell->lead + offset + cols);
+            end = start;
+            tickit_utf8_ncountmore(text, len, &end, &limit);
+
+            if (!s || cell->v.text.bytes > 0 || start.bytes > 0 || end.bytes < len)
+                put_text(dst, line, col, text + start.bytes, end.bytes - start.bytes);
+            else
+                // We can just cheaply copy the entire string
+                put_string(dst, line, col, s);
+        } break;
+        case ERASE:
+            erase(dst, line, col, cols);
+            break;
+        case LINE:
+            linecell(dst, line, col, cell->v.line.mask);
+            break;
+        case CHAR:
+            put_char(dst, line, col, cell->v.chr.codepoint);
+            break;
+        case CONT:
+            /* unreachable */
+            abort();
+    }
+
+    if (cell->state != SKIP)
+        tickit_renderbuffer_restore(dst);
+}
+
+// Replays one line of src's spans into dst by drawing each of them again
+static void copyrect_line(TickitRenderBuffer *dst, TickitRenderBuffer *src, int line,
+    const TickitRect *srcrect, int lineoffs, int coloffs, bool leftwards, bool copy_skip) {
+    int right = tickit_rect_right(srcrect);
+
+    for (int col = leftwards ? right - 1 : srcrect->left;
+         leftwards ? col >= srcrect->left : col < right;
+        /**/) {
+        RBCell *cell = &line_cells(src, line)[col];
+
+        int offset = 0;
+
+        if (cell->state == CONT) {
+            int startcol = cell->startcol;
+            cell         = &line_cells(src, line)[startcol];
+
+            if (leftwards) {
+                col = startcol;
+                if (col < srcrect->left)
+                    col = srcrect->left;
+            }
+
+            offset = col - startcol;
+        }
+
+        // Drawing may overwrite this very cell if dst is src
+        int spancols = cell->cols - offset;
+        int cols     = spancols;
+
+        if (col + cols > right)
+            cols = right - col;
+
+        redraw_span(dst, src, cell, offset, cols, line + lineoffs, col + coloffs, copy_skip);
+
+        if (leftwards)
+            col--; /* we'll jump back to the beginning of a CONT region on the
+                      next iteration
+                    */
+        else
+            col += spancols;
+    }
+}
+
+// Moves one line of cells to elsewhere in the same buffer directly, sharing
+//   their span data rather than drawing each span again. Only possible when
+//   the range begins and ends on span boundaries; returns false otherwise
+static bool copyrect_line_direct(
+    TickitRenderBuffer *rb, int line, const TickitRect *srcrect, int lineoffs, int coloffs) {
+    RBCell *srccells = line_cells(rb, line);
+    int left = srcrect->left, cols = srcrect->cols, right = left + cols;
+
+    if (srccells[left].state == CONT || (right < rb->cols && srccells[right].state == CONT))
+        return false;
+
+    // The source and destination ranges may overlap
+    RBCell moved[cols];
+    memcpy(moved, srccells + left, sizeof moved);
+
+    int dstline = line + lineoffs, dstleft = left + coloffs;
+    RBCell *dstcells = line_cells(rb, dstline);
+
+    for (int c = 0; c < cols; c += moved[c].cols) {
+        RBCell *cell = &moved[c];
+        switch (cell->state) {
+            case LINE:
+                // Line segments merge with any already drawn underneath
+                if (dstcells[dstleft + c].state == LINE)
+                    cell->v.line.mask |= dstcells[dstleft + c].v.line.mask;
+                /* fallthrough */
+            case TEXT:
+            case ERASE:
+            case CHAR:
+                spandata_ref(rb, cell->data);
+                break;
+            case SKIP:
+                break;
+            case CONT:
+                /* unreachable */
+                abort();
+        }
+    }
+
+    // Splits any spans crossing the edges and releases those being replaced
+    make_span(rb, dstline, dstleft, cols);
+
+    dstcells = rb->cells[dstline];
+    memcpy(dstcells + dstleft, moved, sizeof moved);
+    if (coloffs)
+        for (int c = 0; c < cols; c++)
+            if (dstcells[dstleft + c].state == CONT)
+                dstcells[dstleft + c].startcol += coloffs;
+
+    return true;
 }
 
 static void copyrect(TickitRenderBuffer *dst, TickitRenderBuffer *src, const TickitRect *dstrect,
@@ -999,7 +2301,7 @@ static void copyrect(TickitRenderBuffer *dst, TickitRenderBuffer *src, const Tic
      */
     int lineoffs = dstrect->top - srcrect->top, coloffs = dstrect->left - srcrect->left;
 
-    int bottom = tickit_rect_bottom(srcrect), right = tickit_rect_right(srcrect);
+    int bottom = tickit_rect_bottom(srcrect);
 
     /* Several steps have to be done somewhat specially for copies into the same
      * RB
@@ -1014,91 +2316,113 @@ static void copyrect(TickitRenderBuffer *dst, TickitRenderBuffer *src, const Tic
     /* iterate columns leftward if we're copying rightward in the same RB */
     bool leftwards = samerb && (lineoffs == 0) && (coloffs > 0);
 
+    /* Within one RB, cells can be moved directly if drawing them again would
+     * neither translate, clip, mask nor merge a pen into them. Drawing again
+     * merges each cell's pen over the current one, which in turn includes any
+     * saved on the stack
+     */
+    bool direct = samerb && copy_skip && !dst->xlate_line && !dst->xlate_col && !dst->n_masks &&
+                  !tickit_pen_is_nonempty(dst->pen) &&
+                  tickit_rect_contains(&dst->clip, &(TickitRect){.top = dstrect->top,
+                                                       .left  = dstrect->left,
+                                                       .lines = srcrect->lines,
+                                                       .cols  = srcrect->cols});
+
     for (int line = upwards ? bottom - 1 : srcrect->top;
          upwards ? line >= srcrect->top : line < bottom; upwards ? line-- : line++) {
-        for (int col = leftwards ? right - 1 : srcrect->left;
-             leftwards ? col >= srcrect->left : col < right;
-            /**/) {
-            RBCell *cell = &src->cells[line][col];
+        if (direct && copyrect_line_direct(dst, line, srcrect, lineoffs, coloffs))
+            continue;
 
-            int offset = 0;
+        copyrect_line(dst, src, line, srcrect, lineoffs, coloffs, leftwards, copy_skip);
+    }
+}
 
-            if (cell->state == CONT) {
-                int startcol = cell->startcol;
-                cell         = &src->cells[line][startcol];
+// Stores a whole span of src into dst at a position known to be inside dst's
+//   clip and unmasked, sharing its pen and its text if that is shared
+static void blit_span(
+    TickitRenderBuffer *dst, int line, int col, TickitRenderBuffer *src, const RBCell *srccell) {
+    RBSpanData *srcdata = &src->spandata[srccell->data];
+
+    uint32_t data;
+    if (srccell->state == TEXT && srcdata->text != SPANTEXT_SHARED) {
+        // Arena, borrowed or small text needn't outlive dst's frame; copy it there
+        size_t len;
+        const char *text = spandata_text(src, srccell->data, &len);
+        data             = spandata_new_text(dst, srcdata->pen, text, len);
+    } else
+        data = spandata_new(dst, srcdata->pen, srcdata->s);
+
+    RBCell *cell = make_span(dst, line, col, srccell->cols);
+    cell->state  = srccell->state;
+    cell->lead   = srccell->lead;
+    cell->data   = data;
+    cell->v      = srccell->v;
+}
 
-                if (leftwards) {
-                    col = startcol;
-                    if (col < srcrect->left)
-                        col = srcrect->left;
-                }
+void tickit_renderbuffer_blit_at(TickitRenderBuffer *dst, TickitRenderBuffer *src,
+    const TickitRect *srcrect, int dest_line, int dest_col) {
+    TickitRect rect = {.top = 0, .left = 0, .lines = src->lines, .cols = src->cols};
+    if (srcrect && !tickit_rect_intersect(&rect, &rect, srcrect))
+        return;
 
-                offset = col - startcol;
-            }
+    if (dst == src)
+        return;
 
-            int cols = cell->cols;
+    DEBUG_LOGF(dst, "Bd", "Blit " RECT_PRINTF_FMT " to (%d,%d)", RECT_PRINTF_ARGS(rect), dest_col,
+        dest_line);
 
-            if (col + cols > tickit_rect_right(srcrect))
-                cols = tickit_rect_right(srcrect) - col;
+    int lineoffs = dest_line - rect.top, coloffs = dest_col - rect.left;
+    int right    = tickit_rect_right(&rect);
 
-            if (cell->state != SKIP) {
-                tickit_renderbuffer_savepen(dst);
-                tickit_renderbuffer_setpen(dst, cell->pen);
+    /* Drawing a span again would merge its pen over dst's current one; when
+     * that is empty and nothing is masked, whole spans that land inside the
+     * clip can be stored directly instead
+     */
+    bool direct = !dst->n_masks && !tickit_pen_is_nonempty(dst->pen);
+
+    // Skipping isn't copied, so only the dirty columns of src matter
+    for (int line = next_dirty_line(src, rect.top); line < tickit_rect_bottom(&rect);
+         line      = next_dirty_line(src, line + 1)) {
+        int col = src->dirty[line].left, end = src->dirty[line].right;
+        if (col < rect.left)
+            col = rect.left;
+        if (end > right)
+            end = right;
+
+        int dline = line + lineoffs + dst->xlate_line;
+        bool lineclipped =
+            dline < dst->clip.top || dline >= tickit_rect_bottom(&dst->clip) || !dst->clip.lines;
+
+        while (col < end) {
+            RBCell *cell = &src->cells[line][col];
+            int offset   = 0;
+            if (cell->state == CONT) {
+                offset = col - cell->startcol;
+                cell   = &src->cells[line][cell->startcol];
             }
 
-            switch (cell->state) {
-                case SKIP:
-                    if (copy_skip)
-                        skip(dst, line + lineoffs, col + coloffs, cols);
-                    break;
-                case TEXT: {
-                    TickitStringPos start, end, limit;
-                    const char *text = tickit_string_get(cell->v.text.s);
-
-                    tickit_stringpos_limit_columns(&limit, cell->v.text.offs + offset);
-                    tickit_utf8_count(text, &start, &limit);
-
-                    limit.columns += cols;
-                    end = start;
-                    tickit_utf8_countmore(text, &end, &limit);
-
-                    if (start.bytes > 0 || end.bytes < tickit_string_len(cell->v.text.s))
-                        put_text(dst, line + lineoffs, col + coloffs, text + start.bytes,
-                            end.bytes - start.bytes);
-                    else
-                        // We can just cheaply copy the entire string
-                        put_string(dst, line + lineoffs, col + coloffs, cell->v.text.s);
-                } break;
-                case ERASE:
-                    erase(dst, line + lineoffs, col + coloffs, cols);
-                    break;
-                case LINE:
-                    linecell(dst, line + lineoffs, col + coloffs, cell->v.line.mask);
-                    break;
-                case CHAR:
-                    put_char(dst, line + lineoffs, col + coloffs, cell->v.chr.codepoint);
-                    break;
-                case CONT:
-                    /* unreachable */
-                    abort();
-            }
+            int cols = cell->cols - offset;
+            if (col + cols > end)
+                cols = end - col;
 
-            if (cell->state != SKIP)
-                tickit_renderbuffer_restore(dst);
+            int dcol = col + coloffs + dst->xlate_col;
 
-            if (leftwards)
-                col--; /* we'll jump back to the beginning of a CONT region on the
-                          next iteration
-                        */
+            if (cell->state == SKIP)
+                ;
+            else if (direct && !lineclipped && cell->state != LINE && !offset &&
+                     cols == cell->cols && dcol >= dst->clip.left &&
+                     dcol + cols <= tickit_rect_right(&dst->clip))
+                blit_span(dst, dline, dcol, src, cell);
             else
-                col += cell->cols;
+                redraw_span(dst, src, cell, offset, cols, line + lineoffs, col + coloffs, false);
+
+            col += cols;
         }
     }
 }
 
 void tickit_renderbuffer_blit(TickitRenderBuffer *dst, TickitRenderBuffer *src) {
-    copyrect(dst, src, &(TickitRect){.top = 0, .left = 0, .lines = src->lines, .cols = src->cols},
-        &(TickitRect){.top = 0, .left = 0, .lines = src->lines, .cols = src->cols}, false);
+    tickit_renderbuffer_blit_at(dst, src, NULL, 0, 0);
 }
 
 void tickit_renderbuffer_copyrect(
@@ -1134,10 +2458,11 @@ static RBCell *get_span(TickitRenderBuffer *rb, int line, int col, int *offset)
         return NULL;
 
     *offset      = 0;
-    RBCell *cell = &rb->cells[line][col];
+    RBCell *linecells = line_cells(rb, line);
+    RBCell *cell      = &linecells[col];
     if (cell->state == CONT) {
         *offset = col - cell->startcol;
-        cell    = &rb->cells[line][cell->startcol];
+        cell    = &linecells[cell->startcol];
     }
 
     return cell;
@@ -1157,18 +2482,16 @@ static size_t get_span_text(
             break;
 
         case TEXT: {
-            const char *text = tickit_string_get(span->v.text.s);
+            size_t textlen;
             TickitStringPos start, end, limit;
-
-            tickit_stringpos_limit_columns(&limit, span->v.text.offs + offset);
-            tickit_utf8_count(text, &start, &limit);
+            const char *text = span_text_at(rb, span, offset, &textlen, &start);
 
             if (one_grapheme)
                 tickit_stringpos_limit_graphemes(&limit, start.graphemes + 1);
             else
-                tickit_stringpos_limit_columns(&limit, span->cols);
+                tickit_stringpos_limit_columns(&limit, span->lead + span->cols);
             end = start;
-            tickit_utf8_countmore(text, &end, &limit);
+            tickit_utf8_ncountmore(text, textlen, &end, &limit);
 
             bytes = end.bytes - start.bytes;
 
@@ -1235,7 +2558,7 @@ TickitPen *tickit_renderbuffer_get_cell_pen(TickitRenderBuffer *rb, int line, in
     if (!span || span->state == SKIP)
         return NULL;
 
-    return span->pen;
+    return cell_pen(rb, span);
 }
 
 size_t tickit_renderbuffer_get_span(TickitRenderBuffer *rb, int line, int startcol,
@@ -1259,7 +2582,7 @@ size_t tickit_renderbuffer_get_span(TickitRenderBuffer *rb, int line, int startc
 
     if (info && info->pen) {
         tickit_pen_clear(info->pen);
-        tickit_pen_copy(info->pen, span->pen, 1);
+        tickit_pen_copy(info->pen, cell_pen(rb, span), 1);
     }
 
     size_t retlen = get_span_text(rb, span, offset, 0, text, len);
@@ -1269,3 +2592,94 @@ size_t tickit_renderbuffer_get_span(TickitRenderBuffer *rb, int line, int startc
     }
     return len;
 }
+
+// Writes the text of the given columns of a span into buffer, nul-terminated;
+//   returns its length in bytes or -1 if it does not fit
+static size_t export_span_text(
+    TickitRenderBuffer *rb, RBCell *span, int offset, int cols, char *buffer, size_t len) {
+    size_t bytes;
+
+    switch (span->state) {
+        case TEXT: {
+            size_t textlen;
+            TickitStringPos start, end, limit;
+            const char *text = span_text_at(rb, span, offset, &textlen, &start);
+
+            tickit_stringpos_limit_columns(&limit, span->lead + offset + cols);
+            end = start;
+            tickit_utf8_ncountmore(text, textlen, &end, &limit);
+
+            bytes = end.bytes - start.bytes;
+            if (len <= bytes)
+                return -1;
+            memcpy(buffer, text + start.bytes, bytes);
+            break;
+        }
+        case LINE:
+            bytes = tickit_utf8_put(buffer, len, linemask_to_char[span->v.line.mask]);
+            break;
+
+        case CHAR:
+            bytes = tickit_utf8_put(buffer, len, span->v.chr.codepoint);
+            break;
+
+        default:
+            bytes = 0;
+            break;
+    }
+
+    if (bytes == (size_t)-1 || len <= bytes)
+        return -1;
+
+    buffer[bytes] = 0;
+    return bytes;
+}
+
+int tickit_renderbuffer_get_spans(TickitRenderBuffer *rb, const TickitRect *rect,
+    TickitRenderBufferSpan *spans, size_t n, char *buffer, size_t len) {
+    TickitRect area = *rect;
+    tickit_rect_translate(&area, rb->xlate_line, rb->xlate_col);
+    if (!tickit_rect_intersect(&area, &area, &rb->clip))
+        return 0;
+
+    size_t count = 0;
+
+    for (int line = area.top; line < tickit_rect_bottom(&area); line++) {
+        int col = area.left;
+        while (col < tickit_rect_right(&area)) {
+            if (count == n)
+                return count;
+
+            RBCell *span = &line_cells(rb, line)[col];
+            int offset   = 0;
+            if (span->state == CONT) {
+                offset = col - span->startcol;
+                span   = &line_cells(rb, line)[span->startcol];
+            }
+
+            int cols = span->cols - offset;
+            if (cols > tickit_rect_right(&area) - col)
+                cols = tickit_rect_right(&area) - col;
+
+            size_t bytes = export_span_text(rb, span, offset, cols, buffer, len);
+            if (bytes == (size_t)-1)
+                return count;
+
+            spans[count++] = (TickitRenderBufferSpan){
+                .line      = line - rb->xlate_line,
+                .col       = col - rb->xlate_col,
+                .n_columns = cols,
+                .is_active = span->state != SKIP,
+                .text      = buffer,
+                .len       = bytes,
+                .pen       = span->state == SKIP ? NULL : cell_pen(rb, span),
+            };
+
+            buffer += bytes + 1;
+            len -= bytes + 1;
+            col += cols;
+        }
+    }
+
+    return count;
+}
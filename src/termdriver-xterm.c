@@ -208,9 +208,9 @@ static struct SgrOnOff {
     {5, 25},  /* blink */
 };
 
-static bool chpen(TickitTermDriver *ttd, const TickitPen *delta, const TickitPen *final) {
-    struct XTermDriver *xd = (struct XTermDriver *)ttd;
-
+/* INTERNAL */
+size_t tickit_termdrv_xterm_sgr(char *buffer, const TickitPen *delta, const TickitPen *final,
+    bool rgb8, bool csi_sub_colon) {
     /* There can be at most 16 SGR parameters; 5 from each of 2 colours, and
      * 6 single attributes
      */
@@ -231,7 +231,7 @@ static bool chpen(TickitTermDriver *ttd, const TickitPen *delta, const TickitPen
                 val = tickit_pen_get_colour_attr(delta, attr);
                 if (val < 0)
                     params[pindex++] = onoff->off;
-                else if (xd->cap.rgb8 && tickit_pen_has_colour_attr_rgb8(delta, attr)) {
+                else if (rgb8 && tickit_pen_has_colour_attr_rgb8(delta, attr)) {
                     TickitPenRGB8 rgb = tickit_pen_get_colour_attr_rgb8(delta, attr);
                     params[pindex++]  = (onoff->on + 8) | CSI_MORE_SUBPARAM;
                     params[pindex++]  = 2 | CSI_MORE_SUBPARAM;
@@ -284,7 +284,7 @@ static bool chpen(TickitTermDriver *ttd, const TickitPen *delta, const TickitPen
     }
 
     if (pindex == 0)
-        return true;
+        return 0;
 
     /* If we're going to clear all the attributes then empty SGR is neater */
     if (!tickit_pen_is_nondefault(final))
@@ -292,24 +292,28 @@ static bool chpen(TickitTermDriver *ttd, const TickitPen *delta, const TickitPen
 
     /* Render params[] into a CSI string */
 
-    size_t len = 3; /* ESC [ ... m */
-    for (int i = 0; i < pindex; i++)
-        len += snprintf(NULL, 0, "%d", CSI_PARAM(params[i])) + 1;
-    if (pindex > 0)
-        len--; /* Last one has no final separator */
-
-    char *buffer = tickit_termdrv_get_tmpbuffer(ttd, len + 1);
-    char *s      = buffer;
+    char *s = buffer;
 
     s += sprintf(s, "\e[");
     for (int i = 0; i < pindex - 1; i++)
         s += sprintf(s, "%d%c", CSI_PARAM(params[i]),
-            CSI_NEXT_SUB(params[i]) && xd->cap.csi_sub_colon ? ':' : ';');
+            CSI_NEXT_SUB(params[i]) && csi_sub_colon ? ':' : ';');
     if (pindex > 0)
         s += sprintf(s, "%d", CSI_PARAM(params[pindex - 1]));
-    sprintf(s, "m");
+    s += sprintf(s, "m");
+
+    return s - buffer;
+}
+
+static bool chpen(TickitTermDriver *ttd, const TickitPen *delta, const TickitPen *final) {
+    struct XTermDriver *xd = (struct XTermDriver *)ttd;
+
+    char *buffer = tickit_termdrv_get_tmpbuffer(ttd, XTERM_SGR_MAXLEN);
+    size_t len =
+        tickit_termdrv_xterm_sgr(buffer, delta, final, xd->cap.rgb8, xd->cap.csi_sub_colon);
 
-    tickit_termdrv_write_str(ttd, buffer, len);
+    if (len)
+        tickit_termdrv_write_str(ttd, buffer, len);
 
     return true;
 }
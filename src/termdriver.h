@@ -12,3 +12,10 @@ typedef struct {
 
 extern TickitTermDriverProbe tickit_termdrv_probe_xterm;
 extern TickitTermDriverProbe tickit_termdrv_probe_ti;
+
+/* Enough for 16 SGR parameters of up to 3 digits, plus CSI and final */
+#define XTERM_SGR_MAXLEN 80
+
+/* INTERNAL */
+size_t tickit_termdrv_xterm_sgr(char *buffer, const TickitPen *delta, const TickitPen *final,
+    bool rgb8, bool csi_sub_colon);
@@ -45,6 +45,10 @@ struct TickitWindow {
     unsigned int steal_input : 1;
     unsigned int focus_child_notify : 1;
 
+    /* TICKIT_WINCTL_BACKING_STORE; both NULL unless enabled */
+    TickitRenderBuffer *backing;     /* the window's content as last rendered */
+    TickitRectSet *backing_invalid;  /* areas of backing that must be rendered again */
+
     int refcount;
     struct TickitBindings bindings;
 };
@@ -73,6 +77,8 @@ struct TickitRootWindow {
 
     TickitTerm *term;
     TickitRectSet *damage;
+    TickitRenderBuffer *frontbuffer; /* what the terminal is currently showing */
+    TickitRenderBuffer *backbuffer;  /* reused to render each flush */
     HierarchyChange *hierarchy_changes;
     bool needs_expose;
     bool needs_restore;
@@ -90,8 +96,14 @@ struct TickitRootWindow {
     TickitWindow *drag_source_window;
 };
 
+/* INTERNAL */
+void tickit_renderbuffer_diff(TickitRenderBuffer *rb, TickitRenderBuffer *front);
+
 static void _request_restore(TickitRootWindow *root);
 static void _request_later_processing(TickitRootWindow *root);
+static void _reset_backing(TickitWindow *win);
+static void _invalidate_parent_backings(TickitWindow *win, const TickitRect *rect);
+static void _invalidate_backings(TickitWindow *win);
 static void _request_hierarchy_change(HierarchyChangeType, TickitWindow *);
 static void _do_hierarchy_change(
     HierarchyChangeType change, TickitWindow *parent, TickitWindow *win);
@@ -110,6 +122,9 @@ static int on_term_resize(TickitTerm *term, TickitEventFlags flags, void *_info,
     tickit_window_resize(win, info->lines, info->cols);
     DEBUG_LOGF("Ir", "Resize to %dx%d", info->cols, info->lines);
 
+    // The terminal may have reflowed or discarded its content
+    tickit_renderbuffer_reset(root->frontbuffer);
+
     if (info->lines > oldlines) {
         TickitRect damage = {
             .top   = oldlines,
@@ -231,6 +246,8 @@ static void init_window(TickitWindow *win, TickitWindow *parent, TickitRect rect
     win->is_closed          = false;
     win->steal_input        = false;
     win->focus_child_notify = false;
+    win->backing            = NULL;
+    win->backing_invalid    = NULL;
 
     win->refcount = 1;
     win->bindings = (struct TickitBindings){NULL};
@@ -256,12 +273,18 @@ TickitWindow *tickit_window_new_root2(Tickit *t, TickitTerm *term) {
     root->needs_later_processing = false;
     root->tickit                 = t; /* uncounted */
 
+    root->frontbuffer = NULL;
+    root->backbuffer  = NULL;
+
     root->damage = tickit_rectset_new();
     if (!root->damage) {
         tickit_window_destroy(ROOT_AS_WINDOW(root));
         return NULL;
     }
 
+    root->frontbuffer = tickit_renderbuffer_new(lines, cols);
+    root->backbuffer  = tickit_renderbuffer_new(lines, cols);
+
     root->event_ids[0] =
         tickit_term_bind_event(term, TICKIT_TERM_ON_RESIZE, 0, &on_term_resize, root);
     root->event_ids[1] = tickit_term_bind_event(term, TICKIT_TERM_ON_KEY, 0, &on_term_key, root);
@@ -352,6 +375,11 @@ void tickit_window_destroy(TickitWindow *win) {
     if (win->pen)
         tickit_pen_unref(win->pen);
 
+    if (win->backing) {
+        tickit_renderbuffer_unref(win->backing);
+        tickit_rectset_destroy(win->backing_invalid);
+    }
+
     for (TickitWindow *child = win->first_child; child; /**/) {
         TickitWindow *next = child->next;
 
@@ -372,6 +400,10 @@ void tickit_window_destroy(TickitWindow *win) {
         if (root->damage) {
             tickit_rectset_destroy(root->damage);
         }
+        if (root->frontbuffer)
+            tickit_renderbuffer_unref(root->frontbuffer);
+        if (root->backbuffer)
+            tickit_renderbuffer_unref(root->backbuffer);
 
         tickit_term_unbind_event_id(root->term, root->event_ids[0]);
         tickit_term_unbind_event_id(root->term, root->event_ids[1]);
@@ -478,6 +510,18 @@ void tickit_window_set_geometry(TickitWindow *win, TickitRect geom) {
 
         win->rect = geom;
 
+        if (win->backing &&
+            (info.oldrect.lines != geom.lines || info.oldrect.cols != geom.cols))
+            _reset_backing(win);
+
+        /* Any backed parent still holds what was drawn at the old location,
+         * and whatever it would draw under the new one
+         */
+        if (win->is_visible) {
+            _invalidate_parent_backings(win, &info.oldrect);
+            _invalidate_parent_backings(win, &geom);
+        }
+
         run_events(win, TICKIT_WINDOW_ON_GEOMCHANGE, &info);
     }
 }
@@ -504,6 +548,12 @@ void tickit_window_expose(TickitWindow *win, const TickitRect *exposed) {
     } else
         damaged = selfrect;
 
+    /* Content drawn by this window or any descendant has changed, even if it
+     * isn't visible right now
+     */
+    if (win->backing && !tickit_rectset_contains(win->backing_invalid, &damaged))
+        tickit_rectset_add(win->backing_invalid, &damaged);
+
     if (!win->is_visible)
         return;
 
@@ -517,6 +567,16 @@ void tickit_window_expose(TickitWindow *win, const TickitRect *exposed) {
 
     /* If we're here, then we're a root win. */
     TickitRootWindow *root = WINDOW_AS_ROOT(win);
+
+    /* Exposing the whole root is how an application asks for the terminal to
+     * be entirely repainted, e.g. after something else has drawn over it; so
+     * nothing it is remembered to show can be trusted any more
+     */
+    if (!exposed) {
+        tickit_renderbuffer_reset(root->frontbuffer);
+        _invalidate_backings(win);
+    }
+
     if (tickit_rectset_contains(root->damage, &damaged))
         return;
 
@@ -549,10 +609,10 @@ static char *_gen_indent(TickitWindow *win) {
     return buf;
 }
 
-static void _do_expose(TickitWindow *win, const TickitRect *rect, TickitRenderBuffer *rb) {
-    DEBUG_LOGF("Wx", "%sExpose " WINDOW_PRINTF_FMT " " RECT_PRINTF_FMT, _gen_indent(win),
-        WINDOW_PRINTF_ARGS(win), RECT_PRINTF_ARGS(*rect));
+static void _do_expose(TickitWindow *win, const TickitRect *rect, TickitRenderBuffer *rb);
 
+static void _do_expose_content(
+    TickitWindow *win, const TickitRect *rect, TickitRenderBuffer *rb) {
     if (win->pen)
         tickit_renderbuffer_setpen(rb, win->pen);
 
@@ -582,6 +642,93 @@ static void _do_expose(TickitWindow *win, const TickitRect *rect, TickitRenderBu
     run_events(win, TICKIT_WINDOW_ON_EXPOSE, &info);
 }
 
+/* Renders the invalid areas of the window's backing store again */
+static void _update_backing(TickitWindow *win) {
+    TickitRenderBuffer *backing = win->backing;
+
+    int n = tickit_rectset_rects(win->backing_invalid);
+    if (!n)
+        return;
+
+    TickitRect rects[n];
+    tickit_rectset_get_rects(win->backing_invalid, rects, n);
+    tickit_rectset_clear(win->backing_invalid);
+
+    for (int i = 0; i < n; i++) {
+        TickitRect *rect = &rects[i];
+
+        DEBUG_LOGF("Wx", "%sRender backing " WINDOW_PRINTF_FMT " " RECT_PRINTF_FMT,
+            _gen_indent(win), WINDOW_PRINTF_ARGS(win), RECT_PRINTF_ARGS(*rect));
+
+        tickit_renderbuffer_save(backing);
+        tickit_renderbuffer_clip(backing, rect);
+        // Anything not drawn this time must not keep its old content
+        tickit_renderbuffer_skiprect(backing, rect);
+        _do_expose_content(win, rect, backing);
+        tickit_renderbuffer_restore(backing);
+    }
+}
+
+static void _do_expose(TickitWindow *win, const TickitRect *rect, TickitRenderBuffer *rb) {
+    DEBUG_LOGF("Wx", "%sExpose " WINDOW_PRINTF_FMT " " RECT_PRINTF_FMT, _gen_indent(win),
+        WINDOW_PRINTF_ARGS(win), RECT_PRINTF_ARGS(*rect));
+
+    if (!win->backing) {
+        _do_expose_content(win, rect, rb);
+        return;
+    }
+
+    /* Cells keep the pens they were drawn with merged over the window's own,
+     * and blitting merges those over the pen inherited from the parents; so
+     * the result is the same as drawing directly into rb
+     */
+    _update_backing(win);
+    tickit_renderbuffer_blit(rb, win->backing);
+}
+
+static void _reset_backing(TickitWindow *win) {
+    // All of it is invalidated below, so any content kept by resizing is
+    //   redrawn before it is used
+    if (win->backing)
+        tickit_renderbuffer_resize(win->backing, win->rect.lines, win->rect.cols);
+    else
+        win->backing = tickit_renderbuffer_new(win->rect.lines, win->rect.cols);
+
+    tickit_rectset_clear(win->backing_invalid);
+    tickit_rectset_add(win->backing_invalid,
+        &(TickitRect){.top = 0, .left = 0, .lines = win->rect.lines, .cols = win->rect.cols});
+}
+
+/* Invalidates the given area, relative to the window's parent, in the backing
+ * stores of all the window's ancestors
+ */
+static void _invalidate_parent_backings(TickitWindow *win, const TickitRect *rect) {
+    TickitRect parentrect = *rect;
+    for (TickitWindow *parent = win->parent; parent; parent = parent->parent) {
+        TickitRect selfrect = {
+            .top = 0, .left = 0, .lines = parent->rect.lines, .cols = parent->rect.cols};
+        if (!tickit_rect_intersect(&parentrect, &parentrect, &selfrect))
+            return;
+
+        if (parent->backing)
+            tickit_rectset_add(parent->backing_invalid, &parentrect);
+
+        tickit_rect_translate(&parentrect, parent->rect.top, parent->rect.left);
+    }
+}
+
+/* Invalidates the entire backing stores of the window and all its descendants */
+static void _invalidate_backings(TickitWindow *win) {
+    if (win->backing) {
+        tickit_rectset_clear(win->backing_invalid);
+        tickit_rectset_add(win->backing_invalid,
+            &(TickitRect){.top = 0, .left = 0, .lines = win->rect.lines, .cols = win->rect.cols});
+    }
+
+    for (TickitWindow *child = win->first_child; child; child = child->next)
+        _invalidate_backings(child);
+}
+
 static void _request_restore(TickitRootWindow *root) {
     root->needs_restore = true;
     _request_later_processing(root);
@@ -684,8 +831,14 @@ void tickit_window_flush(TickitWindow *win) {
         root->needs_expose = false;
 
         TickitWindow *root_window = ROOT_AS_WINDOW(root);
-        TickitRenderBuffer *rb =
-            tickit_renderbuffer_new(root_window->rect.lines, root_window->rect.cols);
+        int lines = root_window->rect.lines, cols = root_window->rect.cols;
+
+        // Resized in place, so dragging the terminal size around doesn't
+        //   allocate a new pair of buffers every frame
+        tickit_renderbuffer_resize(root->frontbuffer, lines, cols);
+        tickit_renderbuffer_resize(root->backbuffer, lines, cols);
+
+        TickitRenderBuffer *rb = root->backbuffer;
 
         int damage_count  = tickit_rectset_rects(root->damage);
         TickitRect *rects = malloc(damage_count * sizeof(TickitRect));
@@ -703,8 +856,11 @@ void tickit_window_flush(TickitWindow *win) {
 
         free(rects);
 
+        // Only send the cells that differ from what the terminal already shows
+        tickit_renderbuffer_diff(rb, root->frontbuffer);
+
+        // This also resets rb ready for the next flush
         tickit_renderbuffer_flush_to_term(rb, root->term);
-        tickit_renderbuffer_unref(rb);
 
         root->needs_restore = true;
     }
@@ -860,6 +1016,42 @@ static void _purge_hierarchy_changes(TickitWindow *win) {
     }
 }
 
+/* Moves the parts of the pending rects in set that lie within rect along with
+ * content scrolled there; anything scrolled out of rect is dropped
+ */
+static void _scroll_pending(TickitRectSet *set, const TickitRect *rect, int downward, int rightward) {
+    // TODO: This may be more efficiently done with some rectset operations
+    //   instead of completely resetting and rebuilding the set
+    int n_pending = tickit_rectset_rects(set);
+    TickitRect pending[n_pending];
+    tickit_rectset_get_rects(set, pending, n_pending);
+    tickit_rectset_clear(set);
+
+    for (int j = 0; j < n_pending; j++) {
+        TickitRect r = pending[j];
+
+        if (tickit_rect_bottom(&r) < rect->top || r.top > tickit_rect_bottom(rect) ||
+            tickit_rect_right(&r) < rect->left || r.left > tickit_rect_right(rect)) {
+            tickit_rectset_add(set, &r);
+            continue;
+        }
+
+        TickitRect outside[4];
+        int n_outside;
+        if ((n_outside = tickit_rect_subtract(outside, &r, rect))) {
+            for (int k = 0; k < n_outside; k++)
+                tickit_rectset_add(set, outside + k);
+        }
+
+        TickitRect inside;
+        if (tickit_rect_intersect(&inside, &r, rect)) {
+            tickit_rect_translate(&inside, -downward, -rightward);
+            if (tickit_rect_intersect(&inside, &inside, rect))
+                tickit_rectset_add(set, &inside);
+        }
+    }
+}
+
 static bool _scrollrectset(
     TickitWindow *win, TickitRectSet *visible, int downward, int rightward, TickitPen *pen) {
     TickitWindow *origwin = win;
@@ -913,37 +1105,7 @@ static bool _scrollrectset(
             continue;
         }
 
-        // TODO: This may be more efficiently done with some rectset operations
-        //   instead of completely resetting and rebuilding the set
-        TickitRectSet *damageset = WINDOW_AS_ROOT(win)->damage;
-        int n_damage             = tickit_rectset_rects(damageset);
-        TickitRect damage[n_damage];
-        tickit_rectset_get_rects(damageset, damage, n_damage);
-        tickit_rectset_clear(damageset);
-
-        for (int j = 0; j < n_damage; j++) {
-            TickitRect r = damage[j];
-
-            if (tickit_rect_bottom(&r) < rect.top || r.top > tickit_rect_bottom(&rect) ||
-                tickit_rect_right(&r) < rect.left || r.left > tickit_rect_right(&rect)) {
-                tickit_rectset_add(damageset, &r);
-                continue;
-            }
-
-            TickitRect outside[4];
-            int n_outside;
-            if ((n_outside = tickit_rect_subtract(outside, &r, &rect))) {
-                for (int k = 0; k < n_outside; k++)
-                    tickit_rectset_add(damageset, outside + k);
-            }
-
-            TickitRect inside;
-            if (tickit_rect_intersect(&inside, &r, &rect)) {
-                tickit_rect_translate(&inside, -downward, -rightward);
-                if (tickit_rect_intersect(&inside, &inside, &rect))
-                    tickit_rectset_add(damageset, &inside);
-            }
-        }
+        _scroll_pending(WINDOW_AS_ROOT(win)->damage, &rect, downward, rightward);
 
         DEBUG_LOGF("Wsr", "Term scrollrect " RECT_PRINTF_FMT " by %+d,%+d", RECT_PRINTF_ARGS(rect),
             rightward, downward);
@@ -954,6 +1116,9 @@ static bool _scrollrectset(
             done_pen = true;
         }
 
+        // The terminal content in this area no longer matches the front buffer
+        tickit_renderbuffer_skiprect(WINDOW_AS_ROOT(win)->frontbuffer, &rect);
+
         if (tickit_term_scrollrect(term, rect, downward, rightward)) {
             if (downward > 0) {
                 // "scroll down" means lines moved upward, so the bottom needs redrawing
@@ -997,6 +1162,72 @@ static bool _scrollrectset(
     return ret;
 }
 
+/* The scrolled content of a window's own backing store moves along with it;
+ * any backing stores of its parents simply have to render that area again
+ */
+static void _scroll_backing(
+    TickitWindow *win, const TickitRect *rect, int downward, int rightward, bool mask_children) {
+    if (win->backing) {
+        TickitRect src = *rect, dest;
+        tickit_rect_translate(&src, downward, rightward);
+        if (tickit_rect_intersect(&src, &src, rect)) {
+            dest = src;
+            tickit_rect_translate(&dest, -downward, -rightward);
+            tickit_renderbuffer_moverect(win->backing, &dest, &src);
+        }
+
+        // Anything not yet rendered again has moved along with its content
+        TickitRectSet *invalid = win->backing_invalid;
+        _scroll_pending(invalid, rect, downward, rightward);
+
+        if (abs(downward) >= rect->lines || abs(rightward) >= rect->cols)
+            tickit_rectset_add(invalid, rect);
+        else {
+            TickitRect revealed = *rect;
+            if (downward > 0) {
+                revealed.top   = tickit_rect_bottom(rect) - downward;
+                revealed.lines = downward;
+                tickit_rectset_add(invalid, &revealed);
+            } else if (downward < 0) {
+                revealed.lines = -downward;
+                tickit_rectset_add(invalid, &revealed);
+            }
+
+            revealed = *rect;
+            if (rightward > 0) {
+                revealed.left = tickit_rect_right(rect) - rightward;
+                revealed.cols = rightward;
+                tickit_rectset_add(invalid, &revealed);
+            } else if (rightward < 0) {
+                revealed.cols = -rightward;
+                tickit_rectset_add(invalid, &revealed);
+            }
+        }
+
+        /* Children weren't scrolled along with the rest, but what they drew
+         * into the backing store was moved out into the window's own area
+         */
+        if (mask_children)
+            for (TickitWindow *child = win->first_child; child; child = child->next) {
+                if (!child->is_visible)
+                    continue;
+
+                TickitRect childrect;
+                if (tickit_rect_intersect(&childrect, &child->rect, rect))
+                    tickit_rectset_add(invalid, &childrect);
+
+                TickitRect moved = child->rect;
+                tickit_rect_translate(&moved, -downward, -rightward);
+                if (tickit_rect_intersect(&moved, &moved, rect))
+                    tickit_rectset_add(invalid, &moved);
+            }
+    }
+
+    TickitRect parentrect = *rect;
+    tickit_rect_translate(&parentrect, win->rect.top, win->rect.left);
+    _invalidate_parent_backings(win, &parentrect);
+}
+
 static bool _scroll(TickitWindow *win, const TickitRect *origrect, int downward, int rightward,
     TickitPen *pen, bool mask_children) {
     TickitRect rect;
@@ -1029,6 +1260,8 @@ static bool _scroll(TickitWindow *win, const TickitRect *origrect, int downward,
     tickit_rectset_destroy(visible);
     tickit_pen_unref(pen);
 
+    _scroll_backing(win, &rect, downward, rightward, mask_children);
+
     return ret;
 }
 
@@ -1144,6 +1377,10 @@ bool tickit_window_getctl_int(TickitWindow *win, TickitWindowCtl ctl, int *value
             *value = win->cursor.shape;
             return true;
 
+        case TICKIT_WINCTL_BACKING_STORE:
+            *value = !!win->backing;
+            return true;
+
         case TICKIT_N_WINCTLS:;
     }
     return false;
@@ -1171,6 +1408,18 @@ bool tickit_window_setctl_int(TickitWindow *win, TickitWindowCtl ctl, int value)
             win->cursor.shape = value;
             goto restore;
 
+        case TICKIT_WINCTL_BACKING_STORE:
+            if (value && !win->backing) {
+                win->backing_invalid = tickit_rectset_new();
+                _reset_backing(win);
+            } else if (!value && win->backing) {
+                tickit_renderbuffer_unref(win->backing);
+                tickit_rectset_destroy(win->backing_invalid);
+                win->backing         = NULL;
+                win->backing_invalid = NULL;
+            }
+            return true;
+
         case TICKIT_N_WINCTLS:;
     }
     return false;
@@ -1273,6 +1522,8 @@ const char *tickit_window_ctlname(TickitWindowCtl ctl) {
             return "cursor-blink";
         case TICKIT_WINCTL_CURSORSHAPE:
             return "cursor-shape";
+        case TICKIT_WINCTL_BACKING_STORE:
+            return "backing-store";
 
         case TICKIT_N_WINCTLS:;
     }
@@ -1295,6 +1546,7 @@ TickitType tickit_window_ctltype(TickitWindowCtl ctl) {
         case TICKIT_WINCTL_FOCUS_CHILD_NOTIFY:
         case TICKIT_WINCTL_CURSORVIS:
         case TICKIT_WINCTL_CURSORBLINK:
+        case TICKIT_WINCTL_BACKING_STORE:
             return TICKIT_TYPE_BOOL;
 
         case TICKIT_WINCTL_CURSORSHAPE:
@@ -261,6 +261,9 @@ int main(int argc, char *argv[]) {
     test_add("10,10..30,15 20,12..40,20", "10,10..30,12 10,12..40,15 20,15..40,20");
     test_add("10,10..30,15  0,12..20,20", "10,10..30,12  0,12..30,15  0,15..20,20");
 
+    // Stretch then split
+    test_add("11,3..17,9 14,4..22,8 11,4..17,7", "11,3..17,4 11,4..22,8 11,8..17,9");
+
     // Distinct regions
     test_subtract("10,10..30,15 10,20..30,22", "10,10..30,15");
 
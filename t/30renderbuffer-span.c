@@ -46,8 +46,7 @@ int main(int argc, char *argv[]) {
 
         tickit_renderbuffer_flush_to_term(rb, tt);
         is_termlog("RenderBuffer renders text to terminal", GOTO(0, 1), SETPEN(.fg = 1),
-            PRINT("text span"), GOTO(1, 1), SETPEN(.fg = 1), ERASECH(5, -1), GOTO(2, 1),
-            SETPEN(.fg = 1), PRINT("message 123"), NULL);
+            PRINT("text span"), GOTO(1, 1), ERASECH(5, -1), GOTO(2, 1), PRINT("message 123"), NULL);
 
         tickit_renderbuffer_flush_to_term(rb, tt);
         is_termlog("RenderBuffer now empty after render to terminal", NULL);
@@ -112,7 +111,7 @@ int main(int argc, char *argv[]) {
         is_termlog("RenderBuffer spans can be split", GOTO(0, 0), SETPEN(), PRINT("aaa"),
             SETPEN(.b = 1), PRINT("AA"), SETPEN(), PRINT("aaa"), GOTO(1, 0), SETPEN(.b = 1),
             PRINT("BBBBBBBB"), GOTO(2, 0), SETPEN(), PRINT("ccc"), SETPEN(.b = 1), PRINT("CCCCC"),
-            GOTO(3, 0), SETPEN(.b = 1), PRINT("DDDDD"), SETPEN(), PRINT("ddd"), NULL);
+            GOTO(3, 0), PRINT("DDDDD"), SETPEN(), PRINT("ddd"), NULL);
 
         tickit_pen_unref(b_pen);
     }
@@ -126,11 +125,7 @@ int main(int argc, char *argv[]) {
 
         tickit_renderbuffer_flush_to_term(rb, tt);
         is_termlog("RenderBuffer renders overwritten text split chunks", GOTO(0, 0), SETPEN(),
-            PRINT("ab"), SETPEN(), PRINT("-"),           // c
-            SETPEN(), PRINT("d"), SETPEN(), PRINT("-"),  // e
-            SETPEN(), PRINT("f"), SETPEN(), PRINT("-"),  // g
-            SETPEN(), PRINT("h"), SETPEN(), PRINT("-"),  // i
-            SETPEN(), PRINT("jkl"), NULL);
+            PRINT("ab-d-f-h-jkl"), NULL);
     }
 
     // VC spans
@@ -149,8 +144,8 @@ int main(int argc, char *argv[]) {
 
         tickit_renderbuffer_flush_to_term(rb, tt);
         is_termlog("RenderBuffer renders text at VC", GOTO(0, 2), SETPEN(.fg = 3),
-            PRINT("text span"), GOTO(1, 2), SETPEN(.fg = 3), ERASECH(5, -1), GOTO(2, 2),
-            SETPEN(.fg = 3), PRINT("another   string"), NULL);
+            PRINT("text span"), GOTO(1, 2), ERASECH(5, -1), GOTO(2, 2), PRINT("another   string"),
+            NULL);
 
         tickit_pen_unref(fg_pen);
     }
@@ -177,7 +172,7 @@ int main(int argc, char *argv[]) {
 
         tickit_renderbuffer_flush_to_term(rb, tt);
         is_termlog("RenderBuffer renders text with translation", GOTO(3, 5), SETPEN(),
-            PRINT("at 0,0"), GOTO(4, 5), SETPEN(), PRINT("at 1,0"), NULL);
+            PRINT("at 0,0"), GOTO(4, 5), PRINT("at 1,0"), NULL);
     }
 
     // Truncates correctly
@@ -195,8 +190,145 @@ int main(int argc, char *argv[]) {
 
         tickit_renderbuffer_flush_to_term(rb, tt);
         is_termlog("RenderBuffer textn rendering", GOTO(4, 0), SETPEN(), PRINT("ABC"), GOTO(5, 1),
-            SETPEN(), PRINT("ABCDEF"), GOTO(6, 2), SETPEN(), PRINT("LMNOP"), GOTO(7, 3), SETPEN(),
-            PRINT("QRST"), NULL);
+            PRINT("ABCDEF"), GOTO(6, 2), PRINT("LMNOP"), GOTO(7, 3), PRINT("QRST"), NULL);
+    }
+
+    // Borrowed text
+    {
+        // deliberately not NUL-terminated
+        char buffer[] = {'W', 'X', 'Y', 'Z', 'a', 'b', 'c'};
+
+        cols = tickit_renderbuffer_textn_borrowed_at(rb, 4, 0, buffer, 4, -1);
+        is_int(cols, 4, "cols from textn_borrowed_at");
+        cols = tickit_renderbuffer_textn_borrowed_at(rb, 5, 1, "literal", -1, 7);
+        is_int(cols, 7, "cols from textn_borrowed_at given cols");
+
+        tickit_renderbuffer_goto(rb, 6, 2);
+        cols = tickit_renderbuffer_textn_borrowed(rb, buffer + 4, 3, 3);
+        is_int(cols, 3, "cols from textn_borrowed");
+        tickit_renderbuffer_textn_borrowed(rb, buffer, 1, 1);
+
+        tickit_renderbuffer_flush_to_term(rb, tt);
+        is_termlog("RenderBuffer textn_borrowed rendering", GOTO(4, 0), SETPEN(), PRINT("WXYZ"),
+            GOTO(5, 1), PRINT("literal"), GOTO(6, 2), PRINT("abcW"), NULL);
+    }
+
+    // Batched ops
+    {
+        TickitPen *fg_pen = tickit_pen_new_attrs(TICKIT_PEN_FG, 2, 0);
+        TickitPen *bg_pen = tickit_pen_new_attrs(TICKIT_PEN_BG, 4, 0);
+
+        tickit_renderbuffer_savepen(rb);
+        tickit_renderbuffer_setpen(rb, fg_pen);
+
+        TickitRenderBufferOp ops[] = {
+            {TICKIT_RENDERBUFFER_OP_TEXT, 1, 0, NULL, .v.text = {"Hello", -1}},
+            {TICKIT_RENDERBUFFER_OP_TEXT, 1, 6, bg_pen, .v.text = {"world!", 5}},
+            {TICKIT_RENDERBUFFER_OP_ERASE, 2, 0, bg_pen, .v.cols = 3},
+            {TICKIT_RENDERBUFFER_OP_CHAR, 2, 3, NULL, .v.codepoint = 'X'},
+            {TICKIT_RENDERBUFFER_OP_TEXT, 3, 0, NULL, .v.text = {"Skipped", -1}},
+            {TICKIT_RENDERBUFFER_OP_SKIP, 3, 2, NULL, .v.cols = 3},
+        };
+        tickit_renderbuffer_draw_ops(rb, ops, sizeof(ops) / sizeof(ops[0]));
+
+        tickit_renderbuffer_text_at(rb, 4, 0, "After");
+        tickit_renderbuffer_restore(rb);
+
+        tickit_renderbuffer_flush_to_term(rb, tt);
+        is_termlog("RenderBuffer renders batched ops", GOTO(1, 0), SETPEN(.fg = 2), PRINT("Hello"),
+            GOTO(1, 6), SETPEN(.fg = 2, .bg = 4), PRINT("world"), GOTO(2, 0), ERASECH(3, 1),
+            SETPEN(.fg = 2), PRINT("X"), GOTO(3, 0), PRINT("Sk"), GOTO(3, 5), PRINT("ed"),
+            GOTO(4, 0), PRINT("After"), NULL);
+
+        tickit_pen_unref(fg_pen);
+        tickit_pen_unref(bg_pen);
+    }
+
+    // Bulk span extraction
+    {
+        TickitRenderBufferSpan spans[10];
+
+        tickit_renderbuffer_reset(rb);
+
+        tickit_renderbuffer_text_at(rb, 0, 2, "H\xc3\xa9llo");
+        tickit_renderbuffer_erase_at(rb, 0, 8, 4);
+        tickit_renderbuffer_char_at(rb, 1, 1, 'x');
+
+        TickitRect all = {.top = 0, .left = 0, .lines = 2, .cols = 10};
+
+        is_int(tickit_renderbuffer_get_spans(rb, &all, spans, 10, buffer, sizeof buffer), 7,
+            "get_spans returns 7 spans");
+
+        ok(!spans[0].is_active, "get_spans[0] inactive");
+        is_int(spans[0].n_columns, 2, "get_spans[0] n_columns");
+        ok(!spans[0].pen, "get_spans[0] has no pen");
+
+        ok(spans[1].is_active, "get_spans[1] active");
+        is_int(spans[1].col, 2, "get_spans[1] col");
+        is_int(spans[1].n_columns, 5, "get_spans[1] n_columns");
+        is_int(spans[1].len, 6, "get_spans[1] len");
+        is_str(spans[1].text, "H\xc3\xa9llo", "get_spans[1] text");
+        ok(!!spans[1].pen, "get_spans[1] has a pen");
+
+        is_int(spans[3].col, 8, "get_spans[3] col");
+        is_int(spans[3].n_columns, 2, "get_spans[3] n_columns truncated to rect");
+        is_int(spans[3].len, 0, "get_spans[3] ERASE len");
+
+        is_int(spans[5].line, 1, "get_spans[5] line");
+        is_int(spans[5].col, 1, "get_spans[5] col");
+        is_str(spans[5].text, "x", "get_spans[5] text");
+
+        TickitRect part = {.top = 0, .left = 3, .lines = 1, .cols = 3};
+
+        is_int(tickit_renderbuffer_get_spans(rb, &part, spans, 10, buffer, sizeof buffer), 1,
+            "get_spans within a span returns 1 span");
+        is_int(spans[0].n_columns, 3, "get_spans partial n_columns");
+        is_str(spans[0].text, "\xc3\xa9ll", "get_spans partial text");
+
+        is_int(tickit_renderbuffer_get_spans(rb, &all, spans, 2, buffer, sizeof buffer), 2,
+            "get_spans stops when spans run out");
+
+        tickit_renderbuffer_reset(rb);
+    }
+
+    // Reset discards previous content
+    {
+        tickit_renderbuffer_text_at(rb, 0, 0, "Old content");
+        tickit_renderbuffer_reset(rb);
+
+        ok(!tickit_renderbuffer_get_cell_active(rb, 0, 2), "get_cell_active SKIP after reset");
+
+        tickit_renderbuffer_text_at(rb, 0, 4, "New");
+
+        tickit_renderbuffer_flush_to_term(rb, tt);
+        is_termlog("RenderBuffer renders only content since reset", GOTO(0, 4), SETPEN(),
+            PRINT("New"), NULL);
+    }
+
+    // Resize
+    {
+        tickit_renderbuffer_text_at(rb, 0, 0, "Hello world");
+        tickit_renderbuffer_text_at(rb, 1, 15, "End");
+        tickit_renderbuffer_erase_at(rb, 2, 0, 20);
+        tickit_renderbuffer_text_at(rb, 7, 0, "Gone");
+
+        tickit_renderbuffer_resize(rb, 5, 10);
+
+        tickit_renderbuffer_get_size(rb, &lines, &cols);
+        is_int(lines, 5, "get_size lines after resize");
+        is_int(cols, 10, "get_size cols after resize");
+
+        tickit_renderbuffer_flush_to_term(rb, tt);
+        is_termlog("RenderBuffer keeps content when shrunk", GOTO(0, 0), SETPEN(),
+            PRINT("Hello worl"), GOTO(2, 0), ERASECH(10, -1), NULL);
+
+        tickit_renderbuffer_text_at(rb, 4, 5, "Grow");
+        tickit_renderbuffer_resize(rb, 10, 20);
+        tickit_renderbuffer_text_at(rb, 9, 15, "Edge");
+
+        tickit_renderbuffer_flush_to_term(rb, tt);
+        is_termlog("RenderBuffer keeps content when grown", GOTO(4, 5), SETPEN(), PRINT("Grow"),
+            GOTO(9, 15), PRINT("Edge"), NULL);
     }
 
     // Eraserect
@@ -206,8 +338,8 @@ int main(int argc, char *argv[]) {
 
         tickit_renderbuffer_flush_to_term(rb, tt);
         is_termlog("RenderBuffer renders eraserect", GOTO(2, 3), SETPEN(), ERASECH(8, -1),
-            GOTO(3, 3), SETPEN(), ERASECH(8, -1), GOTO(4, 3), SETPEN(), ERASECH(8, -1), GOTO(5, 3),
-            SETPEN(), ERASECH(8, -1), GOTO(6, 3), SETPEN(), ERASECH(8, -1), NULL);
+            GOTO(3, 3), ERASECH(8, -1), GOTO(4, 3), ERASECH(8, -1), GOTO(5, 3), ERASECH(8, -1),
+            GOTO(6, 3), ERASECH(8, -1), NULL);
     }
 
     // Skiprect
@@ -218,9 +350,8 @@ int main(int argc, char *argv[]) {
 
         tickit_renderbuffer_flush_to_term(rb, tt);
         is_termlog("RenderBuffer renders hole around skiprect", GOTO(0, 0), SETPEN(),
-            ERASECH(10, -1), GOTO(1, 0), SETPEN(), ERASECH(2, -1), GOTO(1, 8), SETPEN(),
-            ERASECH(2, -1), GOTO(2, 0), SETPEN(), ERASECH(2, -1), GOTO(2, 8), SETPEN(),
-            ERASECH(2, -1), GOTO(3, 0), SETPEN(), ERASECH(10, -1), NULL);
+            ERASECH(10, -1), GOTO(1, 0), ERASECH(2, -1), GOTO(1, 8), ERASECH(2, -1), GOTO(2, 0),
+            ERASECH(2, -1), GOTO(2, 8), ERASECH(2, -1), GOTO(3, 0), ERASECH(10, -1), NULL);
     }
 
     // Clear
@@ -232,12 +363,10 @@ int main(int argc, char *argv[]) {
 
         tickit_renderbuffer_flush_to_term(rb, tt);
         is_termlog("RenderBuffer renders clear", GOTO(0, 0), SETPEN(.bg = 3), ERASECH(20, -1),
-            GOTO(1, 0), SETPEN(.bg = 3), ERASECH(20, -1), GOTO(2, 0), SETPEN(.bg = 3),
-            ERASECH(20, -1), GOTO(3, 0), SETPEN(.bg = 3), ERASECH(20, -1), GOTO(4, 0),
-            SETPEN(.bg = 3), ERASECH(20, -1), GOTO(5, 0), SETPEN(.bg = 3), ERASECH(20, -1),
-            GOTO(6, 0), SETPEN(.bg = 3), ERASECH(20, -1), GOTO(7, 0), SETPEN(.bg = 3),
-            ERASECH(20, -1), GOTO(8, 0), SETPEN(.bg = 3), ERASECH(20, -1), GOTO(9, 0),
-            SETPEN(.bg = 3), ERASECH(20, -1), NULL);
+            GOTO(1, 0), ERASECH(20, -1), GOTO(2, 0), ERASECH(20, -1), GOTO(3, 0), ERASECH(20, -1),
+            GOTO(4, 0), ERASECH(20, -1), GOTO(5, 0), ERASECH(20, -1), GOTO(6, 0), ERASECH(20, -1),
+            GOTO(7, 0), ERASECH(20, -1), GOTO(8, 0), ERASECH(20, -1), GOTO(9, 0), ERASECH(20, -1),
+            NULL);
 
         tickit_pen_unref(bg_pen);
     }
@@ -20,8 +20,8 @@ int main(int argc, char *argv[]) {
 
         tickit_renderbuffer_flush_to_term(rb, tt);
         is_termlog("RenderBuffer renders hline_at to terminal", GOTO(10, 10), SETPEN(.fg = 1),
-            PRINT("╶───╴"), GOTO(11, 10), SETPEN(.fg = 1), PRINT("────╴"), GOTO(12, 10),
-            SETPEN(.fg = 1), PRINT("╶────"), GOTO(13, 10), SETPEN(.fg = 1), PRINT("─────"), NULL);
+            PRINT("╶───╴"), GOTO(11, 10), PRINT("────╴"), GOTO(12, 10), PRINT("╶────"),
+            GOTO(13, 10), PRINT("─────"), NULL);
 
         tickit_renderbuffer_setpen(rb, fg_pen);
         tickit_renderbuffer_vline_at(rb, 10, 13, 10, TICKIT_LINE_SINGLE, 0);
@@ -31,8 +31,8 @@ int main(int argc, char *argv[]) {
 
         tickit_renderbuffer_flush_to_term(rb, tt);
         is_termlog("RenderBuffer renders vline_at to terminal", GOTO(10, 10), SETPEN(.fg = 1),
-            PRINT("╷│╷│"), GOTO(11, 10), SETPEN(.fg = 1), PRINT("││││"), GOTO(12, 10),
-            SETPEN(.fg = 1), PRINT("││││"), GOTO(13, 10), SETPEN(.fg = 1), PRINT("╵╵││"), NULL);
+            PRINT("╷│╷│"), GOTO(11, 10), PRINT("││││"), GOTO(12, 10), PRINT("││││"), GOTO(13, 10),
+            PRINT("╵╵││"), NULL);
 
         tickit_pen_unref(fg_pen);
     }
@@ -48,7 +48,7 @@ int main(int argc, char *argv[]) {
 
         tickit_renderbuffer_flush_to_term(rb, tt);
         is_termlog("RenderBuffer renders line merging", GOTO(10, 10), SETPEN(), PRINT("┌─┬─┐"),
-            GOTO(11, 10), SETPEN(), PRINT("├─┼─┤"), GOTO(12, 10), SETPEN(), PRINT("└─┴─┘"), NULL);
+            GOTO(11, 10), PRINT("├─┼─┤"), GOTO(12, 10), PRINT("└─┴─┘"), NULL);
     }
 
     tickit_renderbuffer_unref(rb);
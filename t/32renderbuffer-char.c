@@ -24,7 +24,7 @@ int main(int argc, char *argv[]) {
 
         tickit_renderbuffer_flush_to_term(rb, tt);
         is_termlog("RenderBuffer renders char_at to terminal", GOTO(5, 5), SETPEN(.fg = 4),
-            PRINT("A"), SETPEN(.fg = 4), PRINT("B"), SETPEN(.fg = 4), PRINT("C"), NULL);
+            PRINT("ABC"), NULL);
 
         tickit_pen_unref(fg_pen);
     }
@@ -53,7 +53,52 @@ int main(int argc, char *argv[]) {
 
         tickit_renderbuffer_flush_to_term(rb, tt);
         is_termlog("RenderBuffer renders char_at with translation", GOTO(4, 6), SETPEN(),
-            PRINT("1"), SETPEN(), PRINT("2"), NULL);
+            PRINT("12"), NULL);
+    }
+
+    // Cell grid
+    {
+        TickitPen *fg_pen = tickit_pen_new_attrs(TICKIT_PEN_FG, 1, 0);
+        TickitPen *bg_pen = tickit_pen_new_attrs(TICKIT_PEN_BG, 2, 0);
+        const TickitPen *palette[] = {fg_pen, bg_pen};
+
+        TickitRenderBufferCell cells[] = {
+            {'a', 0},
+            {'b', 0},
+            {0x5F8C, 1},
+            {0, 1},
+            {'c', 1},
+            {0, -1},
+            {'d', -1},
+        };
+        tickit_renderbuffer_put_cells(rb, 2, 1, cells, 7, palette);
+        tickit_renderbuffer_put_cells(rb, 3, 0, cells, 2, NULL);
+
+        tickit_renderbuffer_flush_to_term(rb, tt);
+        is_termlog("RenderBuffer renders put_cells", GOTO(2, 1), SETPEN(.fg = 1), PRINT("ab"),
+            SETPEN(.bg = 2), PRINT("後c"), GOTO(2, 7), SETPEN(), PRINT("d"), GOTO(3, 0), PRINT("ab"),
+            NULL);
+
+        tickit_pen_unref(fg_pen);
+        tickit_pen_unref(bg_pen);
+    }
+
+    // Cell grid with a combining mark
+    {
+        TickitRenderBufferCell cells[] = {
+            {'e', -1},
+            {0x0301, -1},
+            {'x', -1},
+            {'y', -1},
+        };
+        tickit_renderbuffer_put_cells(rb, 0, 0, cells, 4, NULL);
+
+        for (int col = 0; col < 4; col++)
+            ok(tickit_renderbuffer_get_cell_active(rb, 0, col), "put_cells fills each column");
+
+        tickit_renderbuffer_flush_to_term(rb, tt);
+        is_termlog("RenderBuffer renders put_cells with a combining mark", GOTO(0, 0), SETPEN(),
+            PRINT("e\xcc\x81xy"), NULL);
     }
 
     tickit_renderbuffer_unref(rb);
@@ -22,7 +22,7 @@ int main(int argc, char *argv[]) {
 
         tickit_renderbuffer_flush_to_term(rb, tt);
         is_termlog("RenderBuffer text rendering with clipping", GOTO(4, 0), SETPEN(),
-            PRINT("LLLLLL]"), GOTO(5, 15), SETPEN(), PRINT("[RRRR"), NULL);
+            PRINT("LLLLLL]"), GOTO(5, 15), PRINT("[RRRR"), NULL);
 
         {
             tickit_renderbuffer_savepen(rb);
@@ -60,8 +60,8 @@ int main(int argc, char *argv[]) {
         tickit_renderbuffer_text(rb, "E");
 
         tickit_renderbuffer_flush_to_term(rb, tt);
-        is_termlog("RenderBuffer text at VC with clipping", GOTO(2, 18), SETPEN(), PRINT("A"),
-            SETPEN(), PRINT("B"), NULL);
+        is_termlog("RenderBuffer text at VC with clipping", GOTO(2, 18), SETPEN(), PRINT("AB"),
+            NULL);
     }
 
     // Clipping to rect
@@ -75,7 +75,7 @@ int main(int argc, char *argv[]) {
 
         tickit_renderbuffer_flush_to_term(rb, tt);
         is_termlog("RenderBuffer renders text rendering with rect clipping", GOTO(4, 2), SETPEN(),
-            PRINT("LLLL]"), GOTO(5, 15), SETPEN(), PRINT("[RR"), NULL);
+            PRINT("LLLL]"), GOTO(5, 15), PRINT("[RR"), NULL);
 
         tickit_renderbuffer_clip(rb, &(TickitRect){.top = 2, .left = 2, .lines = 6, .cols = 16});
 
@@ -122,8 +122,7 @@ int main(int argc, char *argv[]) {
 
         tickit_renderbuffer_flush_to_term(rb, tt);
         is_termlog("RenderBuffer clipping rectangle translated", GOTO(5, 7), SETPEN(),
-            PRINT("22222"), GOTO(6, 7), SETPEN(), PRINT("33333"), GOTO(7, 7), SETPEN(),
-            PRINT("44444"), NULL);
+            PRINT("22222"), GOTO(6, 7), PRINT("33333"), GOTO(7, 7), PRINT("44444"), NULL);
     }
 
     tickit_renderbuffer_unref(rb);
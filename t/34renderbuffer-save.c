@@ -54,8 +54,8 @@ int main(int argc, char *argv[]) {
 
         tickit_renderbuffer_flush_to_term(rb, tt);
         is_termlog("Stack saves/restores clipping region", GOTO(0, 0), SETPEN(),
-            PRINT("0000000000"), GOTO(1, 2), SETPEN(), PRINT("11111111"), GOTO(2, 0), SETPEN(),
-            PRINT("2222222222"), NULL);
+            PRINT("0000000000"), GOTO(1, 2), PRINT("11111111"), GOTO(2, 0), PRINT("2222222222"),
+            NULL);
     }
 
     // Pen
@@ -115,6 +115,32 @@ int main(int argc, char *argv[]) {
         tickit_renderbuffer_flush_to_term(rb, tt);
         is_termlog("Stack saves/restores allow zeroing pen attributes", GOTO(4, 0), SETPEN(.rv = 1),
             PRINT("123"), SETPEN(), PRINT("456"), SETPEN(.rv = 1), PRINT("789"), NULL);
+
+        tickit_renderbuffer_goto(rb, 5, 0);
+
+        pen = tickit_pen_new_attrs(TICKIT_PEN_FG, 2, 0);
+
+        {
+            tickit_renderbuffer_savepen(rb);
+            tickit_renderbuffer_setpen(rb, pen);
+            tickit_renderbuffer_text(rb, "123");
+            tickit_renderbuffer_restore(rb);
+        }
+
+        tickit_pen_set_colour_attr(pen, TICKIT_PEN_FG, 3);
+
+        {
+            tickit_renderbuffer_savepen(rb);
+            tickit_renderbuffer_setpen(rb, pen);
+            tickit_renderbuffer_text(rb, "456");
+            tickit_renderbuffer_restore(rb);
+        }
+
+        tickit_pen_unref(pen);
+
+        tickit_renderbuffer_flush_to_term(rb, tt);
+        is_termlog("Stack setpen observes changes to a previously-set pen", GOTO(5, 0),
+            SETPEN(.fg = 2), PRINT("123"), SETPEN(.fg = 3), PRINT("456"), NULL);
     }
 
     // Translation
@@ -133,7 +159,27 @@ int main(int argc, char *argv[]) {
 
         tickit_renderbuffer_flush_to_term(rb, tt);
         is_termlog("Stack saves/restores translation offset", GOTO(0, 0), SETPEN(), PRINT("A"),
-            GOTO(2, 2), SETPEN(), PRINT("C"), GOTO(3, 3), SETPEN(), PRINT("B"), NULL);
+            GOTO(2, 2), PRINT("C"), GOTO(3, 3), PRINT("B"), NULL);
+    }
+
+    // Deep nesting
+    {
+        for (int i = 0; i < 20; i++) {
+            tickit_renderbuffer_save(rb);
+            if (i % 4 == 0)
+                tickit_renderbuffer_translate(rb, 0, 1);
+        }
+
+        tickit_renderbuffer_text_at(rb, 0, 0, "Deep");
+
+        for (int i = 0; i < 20; i++)
+            tickit_renderbuffer_restore(rb);
+
+        tickit_renderbuffer_text_at(rb, 1, 0, "Top");
+
+        tickit_renderbuffer_flush_to_term(rb, tt);
+        is_termlog("Stack saves/restores many levels deep", GOTO(0, 5), SETPEN(), PRINT("Deep"),
+            GOTO(1, 0), PRINT("Top"), NULL);
     }
 
     tickit_renderbuffer_unref(rb);
@@ -21,8 +21,20 @@ int main(int argc, char *argv[]) {
 
         tickit_renderbuffer_flush_to_term(rb, tt);
         is_termlog("RenderBuffer masking around text", GOTO(3, 2), SETPEN(), PRINT("ABC"),
-            GOTO(5, 11), SETPEN(), PRINT("MN"), GOTO(6, 2), SETPEN(), PRINT("OPQ"), GOTO(6, 11),
-            SETPEN(), PRINT("XYZ"), NULL);
+            GOTO(5, 11), PRINT("MN"), GOTO(6, 2), PRINT("OPQ"), GOTO(6, 11), PRINT("XYZ"), NULL);
+    }
+
+    // Mask over multibyte text
+    {
+        tickit_renderbuffer_mask(rb, &mask);
+
+        tickit_renderbuffer_text_at(rb, 6, 2, "ĉĝĥĵŝŭĉĝĥĵŝŭ");
+        tickit_renderbuffer_text_at(rb, 7, 0, "ĉĝĥĵŝŭ");
+        tickit_renderbuffer_text_at(rb, 7, 2, "X");
+
+        tickit_renderbuffer_flush_to_term(rb, tt);
+        is_termlog("RenderBuffer masking around multibyte text", GOTO(6, 2), SETPEN(), PRINT("ĉĝĥ"),
+            GOTO(6, 11), PRINT("ĵŝŭ"), GOTO(7, 0), PRINT("ĉĝXĵŝŭ"), NULL);
     }
 
     // Mask over erase
@@ -36,8 +48,8 @@ int main(int argc, char *argv[]) {
 
         tickit_renderbuffer_flush_to_term(rb, tt);
         is_termlog("RenderBuffer masking around erasech", GOTO(3, 2), SETPEN(), ERASECH(3, -1),
-            GOTO(5, 11), SETPEN(), ERASECH(2, -1), GOTO(6, 2), SETPEN(), ERASECH(3, -1),
-            GOTO(6, 11), SETPEN(), ERASECH(3, -1), NULL);
+            GOTO(5, 11), ERASECH(2, -1), GOTO(6, 2), ERASECH(3, -1), GOTO(6, 11), ERASECH(3, -1),
+            NULL);
     }
 
     // Mask over lines
@@ -51,8 +63,7 @@ int main(int argc, char *argv[]) {
 
         tickit_renderbuffer_flush_to_term(rb, tt);
         is_termlog("RenderBuffer masking around lines", GOTO(3, 2), SETPEN(), PRINT("╶──"),
-            GOTO(5, 11), SETPEN(), PRINT("──╴"), GOTO(6, 2), SETPEN(), PRINT("╶──"), GOTO(6, 11),
-            SETPEN(), PRINT("───╴"), NULL);
+            GOTO(5, 11), PRINT("──╴"), GOTO(6, 2), PRINT("╶──"), GOTO(6, 11), PRINT("───╴"), NULL);
     }
 
     // Restore removes masks
@@ -69,8 +80,7 @@ int main(int argc, char *argv[]) {
 
         tickit_renderbuffer_flush_to_term(rb, tt);
         is_termlog("RenderBuffer save/restore removes mask", GOTO(3, 0), SETPEN(), PRINT("AAAAA"),
-            GOTO(3, 11), SETPEN(), PRINT("AAAAAAAAA"), GOTO(4, 0), SETPEN(),
-            PRINT("BBBBBBBBBBBBBBBBBBBB"), NULL);
+            GOTO(3, 11), PRINT("AAAAAAAAA"), GOTO(4, 0), PRINT("BBBBBBBBBBBBBBBBBBBB"), NULL);
     }
 
     // translate over mask
@@ -104,7 +114,7 @@ int main(int argc, char *argv[]) {
 
         tickit_renderbuffer_flush_to_term(rb, tt);
         is_termlog("RenderBuffer translate over mask", GOTO(0, 0), SETPEN(), PRINT("A"), GOTO(0, 2),
-            SETPEN(), PRINT("B"), GOTO(2, 0), SETPEN(), PRINT("C"),
+            PRINT("B"), GOTO(2, 0), PRINT("C"),
             // D was masked
             NULL);
     }
@@ -122,6 +132,30 @@ int main(int argc, char *argv[]) {
     }
 
     tickit_renderbuffer_unref(rb);
+
+    // Masks across a wide line
+    {
+        rb = tickit_renderbuffer_new(2, 80);
+
+        tickit_renderbuffer_save(rb);
+        tickit_renderbuffer_mask(rb, &(TickitRect){.top = 0, .left = 60, .lines = 1, .cols = 10});
+        tickit_renderbuffer_mask(rb, &(TickitRect){.top = 0, .left = 5, .lines = 2, .cols = 3});
+
+        tickit_renderbuffer_erase_at(rb, 0, 0, 80);
+        tickit_renderbuffer_erase_at(rb, 1, 0, 10);
+
+        tickit_renderbuffer_restore(rb);
+
+        tickit_renderbuffer_erase_at(rb, 1, 62, 4);
+
+        tickit_renderbuffer_flush_to_term(rb, tt);
+        is_termlog("RenderBuffer masks across a wide line", GOTO(0, 0), SETPEN(), ERASECH(5, -1),
+            GOTO(0, 8), ERASECH(52, -1), GOTO(0, 70), ERASECH(10, -1), GOTO(1, 0), ERASECH(5, -1),
+            GOTO(1, 8), ERASECH(2, -1), GOTO(1, 62), ERASECH(4, -1), NULL);
+
+        tickit_renderbuffer_unref(rb);
+    }
+
     tickit_term_unref(tt);
 
     return exit_status();
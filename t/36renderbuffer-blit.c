@@ -19,13 +19,13 @@ int main(int argc, char *argv[]) {
 
         tickit_renderbuffer_flush_to_term(screen, tt);
         is_termlog("RenderBuffer basic blitting", GOTO(0, 0), SETPEN(), PRINT("Hello"), GOTO(1, 1),
-            SETPEN(), PRINT("A"), NULL);
+            PRINT("A"), NULL);
 
         tickit_renderbuffer_blit(screen, window);
 
         tickit_renderbuffer_flush_to_term(screen, tt);
         is_termlog("RenderBuffer blitting doesn't wipe src rb", GOTO(0, 0), SETPEN(),
-            PRINT("Hello"), GOTO(1, 1), SETPEN(), PRINT("A"), NULL);
+            PRINT("Hello"), GOTO(1, 1), PRINT("A"), NULL);
     }
 
     // Blitting an erase wipes underlying content
@@ -38,7 +38,7 @@ int main(int argc, char *argv[]) {
 
         tickit_renderbuffer_flush_to_term(screen, tt);
         is_termlog("RenderBuffer blit can erase underlying content", GOTO(0, 0), SETPEN(),
-            ERASECH(4, 1), SETPEN(), PRINT("o"), NULL);
+            ERASECH(4, 1), PRINT("o"), NULL);
     }
 
     // Blitting text that spans a mask
@@ -52,7 +52,7 @@ int main(int argc, char *argv[]) {
 
         tickit_renderbuffer_flush_to_term(screen, tt);
         is_termlog("RenderBuffer blit can have text spanning a mask", GOTO(0, 0), SETPEN(),
-            PRINT("He"), GOTO(0, 3), SETPEN(), PRINT("lo"), NULL);
+            PRINT("He"), GOTO(0, 3), PRINT("lo"), NULL);
     }
 
     // Blitting merges line segments
@@ -66,8 +66,7 @@ int main(int argc, char *argv[]) {
 
         tickit_renderbuffer_flush_to_term(screen, tt);
         is_termlog("RenderBuffer blit merges line segments", GOTO(0, 5), SETPEN(), PRINT("╷"),
-            GOTO(1, 0), SETPEN(), PRINT("╶────┼──────────────"), GOTO(2, 5), SETPEN(), PRINT("╵"),
-            NULL);
+            GOTO(1, 0), PRINT("╶────┼──────────────"), GOTO(2, 5), PRINT("╵"), NULL);
     }
 
     // Blitting obeys translation
@@ -84,7 +83,7 @@ int main(int argc, char *argv[]) {
 
         tickit_renderbuffer_flush_to_term(screen, tt);
         is_termlog("RenderBuffer blit obeys translation", GOTO(5, 8), SETPEN(), PRINT("Hello"),
-            GOTO(7, 11), SETPEN(), PRINT("B"), NULL);
+            GOTO(7, 11), PRINT("B"), NULL);
     }
 
     // Blitting obeys clipping
@@ -104,6 +103,55 @@ int main(int argc, char *argv[]) {
         is_termlog("RenderBuffer blit obeys clipping", GOTO(2, 2), SETPEN(), PRINT("rld"), NULL);
     }
 
+    // Blitting part of a buffer elsewhere
+    {
+        tickit_renderbuffer_reset(window);
+
+        tickit_renderbuffer_text_at(window, 0, 0, "Hello World");
+        tickit_renderbuffer_erase_at(window, 1, 4, 4);
+        tickit_renderbuffer_char_at(window, 1, 9, 'Z');
+
+        tickit_renderbuffer_blit_at(
+            screen, window, &(TickitRect){.top = 0, .left = 6, .lines = 2, .cols = 5}, 10, 30);
+
+        tickit_renderbuffer_save(screen);
+        tickit_renderbuffer_translate(screen, 12, 0);
+        tickit_renderbuffer_mask(screen, &(TickitRect){.top = 1, .left = 2, .lines = 1, .cols = 1});
+
+        TickitRect hello = {.top = 0, .left = 0, .lines = 1, .cols = 5};
+        tickit_renderbuffer_blit_at(screen, window, &hello, 0, 0);
+        tickit_renderbuffer_blit_at(screen, window, &hello, 1, 0);
+
+        tickit_renderbuffer_restore(screen);
+
+        tickit_renderbuffer_flush_to_term(screen, tt);
+        is_termlog("RenderBuffer blit_at of part of a buffer",
+            GOTO(10, 30), SETPEN(), PRINT("World"),
+            GOTO(11, 30), ERASECH(2, -1),
+            GOTO(11, 33), PRINT("Z"),
+            GOTO(12, 0), PRINT("Hello"),
+            GOTO(13, 0), PRINT("He"),
+            GOTO(13, 3), PRINT("lo"),
+            NULL);
+    }
+
+    // Blitting a viewport of a tall buffer
+    {
+        TickitRenderBuffer *doc = tickit_renderbuffer_new(10000, 20);
+
+        tickit_renderbuffer_text_at(doc, 5000, 2, "Middle");
+        tickit_renderbuffer_text_at(doc, 5003, 0, "Later");
+
+        tickit_renderbuffer_blit_at(
+            screen, doc, &(TickitRect){.top = 4999, .left = 0, .lines = 3, .cols = 20}, 0, 0);
+
+        tickit_renderbuffer_flush_to_term(screen, tt);
+        is_termlog("RenderBuffer blit_at from a tall buffer", GOTO(1, 2), SETPEN(),
+            PRINT("Middle"), NULL);
+
+        tickit_renderbuffer_unref(doc);
+    }
+
     // Blitting overrides destination's pen
     {
         tickit_renderbuffer_reset(window);
@@ -144,7 +192,7 @@ int main(int argc, char *argv[]) {
         is_termlog("RenderBuffer basic blitting", GOTO(0, 0), SETPEN(.fg = 5), PRINT("Hello"),
             GOTO(1, 1), SETPEN(.fg = 5, .bg = 6), PRINT("A"), GOTO(2, 2), SETPEN(.fg = 4, .bg = 6),
             PRINT("World"), GOTO(3, 3), SETPEN(.fg = 4), PRINT("Again"), GOTO(4, 4),
-            SETPEN(.fg = 4), PRINT("Preserved Pen"), NULL);
+            PRINT("Preserved Pen"), NULL);
 
         tickit_pen_unref(bg_pen);
     }
@@ -20,11 +20,9 @@ int main(int argc, char *argv[]) {
         tickit_renderbuffer_flush_to_term(rb, tt);
         is_termlog("RenderBuffer contents duplicated after copyrect",
             /* orig */
-            GOTO(0, 0), SETPEN(), PRINT("Hello"), GOTO(1, 1), SETPEN(), PRINT("A"), SETPEN(),
-            ERASECH(3, -1),
+            GOTO(0, 0), SETPEN(), PRINT("Hello"), GOTO(1, 1), PRINT("A"), ERASECH(3, -1),
             /* copy */
-            GOTO(4, 2), SETPEN(), PRINT("Hello"), GOTO(5, 3), SETPEN(), PRINT("A"), SETPEN(),
-            ERASECH(3, -1), NULL);
+            GOTO(4, 2), PRINT("Hello"), GOTO(5, 3), PRINT("A"), ERASECH(3, -1), NULL);
     }
 
     // Truncate right
@@ -38,9 +36,9 @@ int main(int argc, char *argv[]) {
         tickit_renderbuffer_flush_to_term(rb, tt);
         is_termlog("RenderBuffer copyrect can truncate to right",
             /* orig */
-            GOTO(0, 0), SETPEN(), PRINT("ABCDE"), GOTO(1, 0), SETPEN(), ERASECH(6, -1),
+            GOTO(0, 0), SETPEN(), PRINT("ABCDE"), GOTO(1, 0), ERASECH(6, -1),
             /* copy */
-            GOTO(4, 0), SETPEN(), PRINT("ABC"), GOTO(5, 0), SETPEN(), ERASECH(3, -1), NULL);
+            GOTO(4, 0), PRINT("ABC"), GOTO(5, 0), ERASECH(3, -1), NULL);
     }
 
     // Truncate left
@@ -54,9 +52,9 @@ int main(int argc, char *argv[]) {
         tickit_renderbuffer_flush_to_term(rb, tt);
         is_termlog("RenderBuffer copyrect can truncate to left",
             /* orig */
-            GOTO(0, 0), SETPEN(), PRINT("ABCDE"), GOTO(1, 0), SETPEN(), ERASECH(6, -1),
+            GOTO(0, 0), SETPEN(), PRINT("ABCDE"), GOTO(1, 0), ERASECH(6, -1),
             /* copy */
-            GOTO(4, 2), SETPEN(), PRINT("CDE"), GOTO(5, 2), SETPEN(), ERASECH(3, -1), NULL);
+            GOTO(4, 2), PRINT("CDE"), GOTO(5, 2), ERASECH(3, -1), NULL);
     }
 
     // Overlap upwards
@@ -70,7 +68,7 @@ int main(int argc, char *argv[]) {
 
         tickit_renderbuffer_flush_to_term(rb, tt);
         is_termlog("RenderBuffer copyrect can copy upwards", GOTO(0, 0), SETPEN(), PRINT("Fghij"),
-            GOTO(1, 0), SETPEN(), PRINT("Klmno"), GOTO(2, 0), SETPEN(), PRINT("Klmno"), NULL);
+            GOTO(1, 0), PRINT("Klmno"), GOTO(2, 0), PRINT("Klmno"), NULL);
     }
 
     // Overlap downwards
@@ -84,7 +82,7 @@ int main(int argc, char *argv[]) {
 
         tickit_renderbuffer_flush_to_term(rb, tt);
         is_termlog("RenderBuffer copyrect can copy downwards", GOTO(0, 0), SETPEN(), PRINT("aBcde"),
-            GOTO(1, 0), SETPEN(), PRINT("aBcde"), GOTO(2, 0), SETPEN(), PRINT("fGhij"), NULL);
+            GOTO(1, 0), PRINT("aBcde"), GOTO(2, 0), PRINT("fGhij"), NULL);
     }
 
     // Overlap leftwards
@@ -97,8 +95,8 @@ int main(int argc, char *argv[]) {
             &(TickitRect){.top = 0, .left = 3, .lines = 1, .cols = 6});
 
         tickit_renderbuffer_flush_to_term(rb, tt);
-        is_termlog("RenderBuffer copyrect can copy leftwards", GOTO(0, 0), SETPEN(), PRINT("Def"),
-            SETPEN(), PRINT("Ghi"), SETPEN(), PRINT("Ghi"), NULL);
+        is_termlog("RenderBuffer copyrect can copy leftwards", GOTO(0, 0), SETPEN(),
+            PRINT("DefGhiGhi"), NULL);
     }
 
     // Overlap rightwards
@@ -111,8 +109,25 @@ int main(int argc, char *argv[]) {
             &(TickitRect){.top = 0, .left = 0, .lines = 1, .cols = 6});
 
         tickit_renderbuffer_flush_to_term(rb, tt);
-        is_termlog("RenderBuffer copyrect can copy rightwards", GOTO(0, 0), SETPEN(), PRINT("aBc"),
-            SETPEN(), PRINT("aBc"), SETPEN(), PRINT("dEf"), NULL);
+        is_termlog("RenderBuffer copyrect can copy rightwards", GOTO(0, 0), SETPEN(),
+            PRINT("aBcaBcdEf"), NULL);
+    }
+
+    // Copy of text that outgrows the buffer's text storage
+    {
+        char text[2046];
+        for (int i = 0; i < 2045; i++)
+            text[i] = 'a' + i % 26;
+        text[2045] = 0;
+
+        tickit_renderbuffer_text_at(rb, 0, 0, text);
+
+        tickit_renderbuffer_copyrect(rb, &(TickitRect){.top = 4, .left = 0, .lines = 1, .cols = 5},
+            &(TickitRect){.top = 0, .left = 2, .lines = 1, .cols = 5});
+
+        tickit_renderbuffer_flush_to_term(rb, tt);
+        is_termlog("RenderBuffer copyrect of long text", GOTO(0, 0), SETPEN(),
+            PRINT("abcdefghijklmnopqrst"), GOTO(4, 0), PRINT("cdefg"), NULL);
     }
 
     // Move
@@ -126,7 +141,7 @@ int main(int argc, char *argv[]) {
 
         tickit_renderbuffer_flush_to_term(rb, tt);
         is_termlog("RenderBuffer contents moved after move", GOTO(4, 2), SETPEN(), PRINT("Hello"),
-            GOTO(5, 3), SETPEN(), PRINT("A"), SETPEN(), ERASECH(3, -1), NULL);
+            GOTO(5, 3), PRINT("A"), ERASECH(3, -1), NULL);
     }
 
     // Move with overlap
@@ -141,6 +156,42 @@ int main(int argc, char *argv[]) {
             PRINT("de"), NULL);
     }
 
+    // Move of whole spans, onto lines and across a span
+    {
+        tickit_renderbuffer_text_at(rb, 0, 0, "Hello");
+        tickit_renderbuffer_erase_at(rb, 0, 6, 4);
+        tickit_renderbuffer_hline_at(rb, 1, 0, 3, TICKIT_LINE_SINGLE, 0);
+        tickit_renderbuffer_text_at(rb, 3, 0, "0123456789");
+        tickit_renderbuffer_vline_at(rb, 2, 3, 4, TICKIT_LINE_SINGLE, 0);
+
+        tickit_renderbuffer_moverect(rb, &(TickitRect){.top = 2, .left = 2, .lines = 2, .cols = 10},
+            &(TickitRect){.top = 0, .left = 0, .lines = 2, .cols = 10});
+
+        tickit_renderbuffer_flush_to_term(rb, tt);
+        is_termlog("RenderBuffer moverect of whole spans", GOTO(2, 2), SETPEN(), PRINT("Hello"),
+            GOTO(2, 8), ERASECH(4, -1), GOTO(3, 0), PRINT("01╶─┴╴"), NULL);
+    }
+
+    // Move merges the current pen
+    {
+        TickitPen *bold = tickit_pen_new_attrs(TICKIT_PEN_BOLD, 1, 0);
+
+        tickit_renderbuffer_text_at(rb, 0, 0, "Hello");
+
+        tickit_renderbuffer_setpen(rb, bold);
+        tickit_renderbuffer_moverect(rb, &(TickitRect){.top = 1, .left = 0, .lines = 1, .cols = 5},
+            &(TickitRect){.top = 0, .left = 0, .lines = 1, .cols = 5});
+
+        ok(tickit_pen_get_bool_attr(tickit_renderbuffer_get_cell_pen(rb, 1, 0), TICKIT_PEN_BOLD),
+            "moved cell has the current pen merged");
+
+        tickit_renderbuffer_flush_to_term(rb, tt);
+        is_termlog("RenderBuffer moverect merges the current pen", GOTO(1, 0), SETPEN(.b = 1),
+            PRINT("Hello"), NULL);
+
+        tickit_pen_unref(bold);
+    }
+
     tickit_renderbuffer_unref(rb);
     tickit_term_unref(tt);
 
@@ -0,0 +1,120 @@
+#include "taplib.h"
+#include "tickit.h"
+
+#include <string.h>
+
+int main(int argc, char *argv[]) {
+    TickitRenderBuffer *rb;
+    char buffer[256];
+    size_t len;
+
+    rb = tickit_renderbuffer_new(10, 20);
+
+    // Empty
+    {
+        len = tickit_renderbuffer_encode(rb, NULL, buffer, sizeof buffer);
+        is_int(len, 0, "encode length of empty RenderBuffer");
+    }
+
+    // Text and erase
+    {
+        TickitPen *fg_pen = tickit_pen_new_attrs(TICKIT_PEN_FG, 1, TICKIT_PEN_BOLD, 1, 0);
+
+        tickit_renderbuffer_text_at(rb, 0, 0, "Hello");
+        tickit_renderbuffer_setpen(rb, fg_pen);
+        tickit_renderbuffer_text_at(rb, 0, 6, "world");
+        tickit_renderbuffer_erase_at(rb, 1, 2, 4);
+        tickit_renderbuffer_char_at(rb, 1, 6, 'X');
+
+        len = tickit_renderbuffer_encode(rb, NULL, buffer, sizeof buffer);
+        buffer[len] = 0;
+        is_str_escape(buffer,
+            "\e[1H\e[mHello\e[1;7H\e[31;1mworld\e[2;3H\e[4X\e[4CX",
+            "encode text and erase");
+        is_int(len, strlen(buffer), "encode returns length");
+
+        tickit_pen_unref(fg_pen);
+    }
+
+    // Bands of lines
+    {
+        len = tickit_renderbuffer_encode_lines(rb, NULL, 1, 2, buffer, sizeof buffer);
+        buffer[len] = 0;
+        is_str_escape(buffer, "\e[2;3H\e[m\e[31;1m\e[4X\e[4CX", "encode_lines of second line alone");
+
+        len = tickit_renderbuffer_encode_lines(rb, NULL, 0, 1, buffer, sizeof buffer);
+        buffer[len] = 0;
+        is_str_escape(buffer, "\e[1H\e[mHello\e[1;7H\e[31;1mworld", "encode_lines of first line alone");
+
+        len = tickit_renderbuffer_encode_lines(rb, NULL, 2, 10, buffer, sizeof buffer);
+        is_int(len, 0, "encode_lines of empty lines");
+
+        len = tickit_renderbuffer_encode_lines(rb, NULL, -5, 50, NULL, 0);
+        is_int(len, tickit_renderbuffer_encode(rb, NULL, NULL, 0), "encode_lines clips to buffer size");
+    }
+
+    // Short buffer
+    {
+        char shortbuf[8];
+        memset(shortbuf, 'Z', sizeof shortbuf);
+
+        size_t fulllen = tickit_renderbuffer_encode(rb, NULL, NULL, 0);
+        is_int(fulllen, len, "encode without buffer returns full length");
+
+        tickit_renderbuffer_encode(rb, NULL, shortbuf, 4);
+        ok(!memcmp(shortbuf, "\e[1HZ", 5), "encode truncates to buffer size");
+    }
+
+    // Reverse-video erase and RGB8 colours
+    {
+        TickitPen *pen = tickit_pen_new_attrs(TICKIT_PEN_REVERSE, 1, 0);
+        tickit_pen_set_colour_attr(pen, TICKIT_PEN_BG, 4);
+        tickit_pen_set_colour_attr_rgb8(pen, TICKIT_PEN_BG, (TickitPenRGB8){0x10, 0x20, 0x30});
+
+        tickit_renderbuffer_reset(rb);
+        tickit_renderbuffer_setpen(rb, pen);
+        tickit_renderbuffer_erase_at(rb, 2, 0, 3);
+
+        len = tickit_renderbuffer_encode(rb, NULL, buffer, sizeof buffer);
+        buffer[len] = 0;
+        is_str_escape(buffer, "\e[3H\e[m\e[44;7m   ", "encode reverse-video erase");
+
+        len = tickit_renderbuffer_encode(rb,
+            &(struct TickitRenderBufferEncodeProfile){.rgb8 = true, .csi_sub_colon = true},
+            buffer, sizeof buffer);
+        buffer[len] = 0;
+        is_str_escape(buffer, "\e[3H\e[m\e[48:2:16:32:48;7m   ", "encode with RGB8 profile");
+
+        tickit_pen_unref(pen);
+    }
+
+    tickit_renderbuffer_unref(rb);
+
+    // Lines spread across a tall buffer
+    {
+        rb = tickit_renderbuffer_new(150, 20);
+
+        tickit_renderbuffer_text_at(rb, 3, 2, "Top");
+        tickit_renderbuffer_text_at(rb, 70, 5, "Middle");
+        tickit_renderbuffer_skip_at(rb, 100, 0, 5);
+        tickit_renderbuffer_erase_at(rb, 149, 10, 4);
+
+        len = tickit_renderbuffer_encode(rb, NULL, buffer, sizeof buffer);
+        buffer[len] = 0;
+        is_str_escape(buffer, "\e[4;3H\e[mTop\e[71;6HMiddle\e[150;11H\e[4X",
+            "encode lines of a tall buffer");
+
+        len = tickit_renderbuffer_encode_lines(rb, NULL, 64, 149, buffer, sizeof buffer);
+        buffer[len] = 0;
+        is_str_escape(buffer, "\e[71;6H\e[mMiddle", "encode_lines of a tall buffer");
+
+        tickit_renderbuffer_reset(rb);
+
+        len = tickit_renderbuffer_encode(rb, NULL, buffer, sizeof buffer);
+        is_int(len, 0, "encode length of tall RenderBuffer after reset");
+
+        tickit_renderbuffer_unref(rb);
+    }
+
+    return exit_status();
+}
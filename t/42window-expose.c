@@ -69,6 +69,16 @@ int on_expose_fillX(TickitWindow *win, TickitEventFlags flags, void *_info, void
     return 1;
 }
 
+int on_expose_fill(TickitWindow *win, TickitEventFlags flags, void *_info, void *data) {
+    TickitExposeEventInfo *info = _info;
+
+    for (int line = info->rect.top; line < tickit_rect_bottom(&info->rect); line++)
+        for (int col = info->rect.left; col < tickit_rect_right(&info->rect); col++)
+            tickit_renderbuffer_char_at(info->rb, line, col, *(char *)data);
+
+    return 1;
+}
+
 int on_expose_textat(TickitWindow *win, TickitEventFlags flags, void *_info, void *data) {
     TickitExposeEventInfo *info = _info;
 
@@ -76,6 +86,30 @@ int on_expose_textat(TickitWindow *win, TickitEventFlags flags, void *_info, voi
     return 1;
 }
 
+// Renders the rows of a document scrolled to the offset given by data
+int on_expose_render_rows(TickitWindow *win, TickitEventFlags flags, void *_info, void *data) {
+    TickitExposeEventInfo *info = _info;
+
+    tickit_renderbuffer_eraserect(info->rb, &info->rect);
+    for (int line = info->rect.top; line < tickit_rect_bottom(&info->rect); line++) {
+        char buffer[16];
+        sprintf(buffer, "Row %d", line + *(int *)data);
+        tickit_renderbuffer_text_at(info->rb, line, 0, buffer);
+    }
+
+    return 1;
+}
+
+static void is_display_text(TickitTerm *tt, int line, int col, char *expect, char *name) {
+    char got[16];
+    tickit_mockterm_get_display_text((TickitMockTerm *)tt, got, sizeof got, line, col, 10);
+    is_str(got, expect, name);
+}
+
+static void is_display_line(TickitTerm *tt, int line, char *expect, char *name) {
+    is_display_text(tt, line, 0, expect, name);
+}
+
 int main(int argc, char *argv[]) {
     TickitTerm *tt     = make_term(25, 80);
     TickitWindow *root = tickit_window_new_root(tt);
@@ -198,7 +232,7 @@ int main(int argc, char *argv[]) {
         tickit_window_flush(root);
 
         is_termlog("Termlog after Window expose with output", GOTO(4, 11), SETPEN(),
-            PRINT("The text"), GOTO(5, 12), SETPEN(), ERASECH(4, -1), NULL);
+            PRINT("The text"), GOTO(5, 12), ERASECH(4, -1), NULL);
 
         idx = 2;
 
@@ -207,15 +241,20 @@ int main(int argc, char *argv[]) {
         tickit_window_flush(root);
 
         is_termlog("Termlog after Window expose twice", GOTO(3, 10), SETPEN(), PRINT("Line 0"),
-            GOTO(5, 10), SETPEN(), PRINT("Line 2"), NULL);
+            GOTO(5, 10), PRINT("Line 2"), NULL);
 
         tickit_pen_set_colour_attr(tickit_window_get_pen(win), TICKIT_PEN_FG, 5);
         tickit_window_expose(win, NULL);
         tickit_window_flush(root);
 
         is_termlog("Termlog after Window expose with pen attrs", GOTO(3, 10), SETPEN(.fg = 5),
-            PRINT("Line 0"), GOTO(4, 10), SETPEN(.fg = 5), PRINT("Line 1"), GOTO(5, 10),
-            SETPEN(.fg = 5), PRINT("Line 2"), GOTO(6, 10), SETPEN(.fg = 5), PRINT("Line 3"), NULL);
+            PRINT("Line 0"), GOTO(4, 10), PRINT("Line 1"), GOTO(5, 10), PRINT("Line 2"),
+            GOTO(6, 10), PRINT("Line 3"), NULL);
+
+        tickit_window_expose(win, NULL);
+        tickit_window_flush(root);
+
+        is_termlog("Termlog empty after Window expose with unchanged output", NULL);
 
         tickit_window_unbind_event_id(win, bind_id);
         tickit_pen_clear_attr(tickit_window_get_pen(win), TICKIT_PEN_FG);
@@ -295,8 +334,7 @@ int main(int argc, char *argv[]) {
         tickit_window_flush(root);
 
         is_termlog("Display after simultaneous expose in parent + child", GOTO(3, 10), SETPEN(),
-            PRINT("Parent"), GOTO(3, 17), SETPEN(), PRINT("Child"), GOTO(3, 24), SETPEN(),
-            PRINT("Parent"), NULL);
+            PRINT("Parent"), GOTO(3, 17), PRINT("Child"), GOTO(3, 24), PRINT("Parent"), NULL);
 
         tickit_window_unref(sub);
 
@@ -333,7 +371,7 @@ int main(int argc, char *argv[]) {
         tickit_window_flush(root);
 
         is_termlog("Termlog after expose parent with visible child", GOTO(3, 10), SETPEN(),
-            PRINT("XXXXX"), GOTO(3, 25), SETPEN(), PRINT("XXXXX"), NULL);
+            PRINT("XXXXX"), GOTO(3, 25), PRINT("XXXXX"), NULL);
 
         tickit_window_unref(sub);
         tickit_window_unbind_event_id(win, bind_id);
@@ -363,26 +401,275 @@ int main(int argc, char *argv[]) {
         tickit_window_raise(winB);
         tickit_window_flush(root);
 
-        is_termlog("Termlog for overlapping after winB raise", GOTO(0, 0), SETPEN(),
-            PRINT("Window B"), NULL);
+        is_termlog(
+            "Termlog for overlapping after winB raise", GOTO(0, 7), SETPEN(), PRINT("B"), NULL);
 
         tickit_window_lower(winB);
         tickit_window_flush(root);
 
-        is_termlog("Termlog for overlapping after winB lower", GOTO(0, 0), SETPEN(),
-            PRINT("Window A"), NULL);
+        is_termlog(
+            "Termlog for overlapping after winB lower", GOTO(0, 7), SETPEN(), PRINT("A"), NULL);
 
         tickit_window_raise_to_front(winC);
         tickit_window_flush(root);
 
-        is_termlog("Termlog for overlapping after winC raise_to_front", GOTO(0, 0), SETPEN(),
-            PRINT("Window C"), NULL);
+        is_termlog("Termlog for overlapping after winC raise_to_front", GOTO(0, 7), SETPEN(),
+            PRINT("C"), NULL);
 
         tickit_window_unref(winA);
         tickit_window_unref(winB);
         tickit_window_unref(winC);
     }
 
+    // Backing store
+    {
+        TickitWindow *chart = tickit_window_new(root, (TickitRect){5, 0, 3, 80}, 0);
+
+        int exposed = 0;
+        tickit_window_bind_event(chart, TICKIT_WINDOW_ON_EXPOSE, 0, &on_expose_incr, &exposed);
+        int idx = 2;
+        tickit_window_bind_event(chart, TICKIT_WINDOW_ON_EXPOSE, 0, &on_expose_render_text, &idx);
+
+        int value;
+        tickit_window_setctl_int(chart, TICKIT_WINCTL_BACKING_STORE, 1);
+        tickit_window_getctl_int(chart, TICKIT_WINCTL_BACKING_STORE, &value);
+        is_int(value, 1, "backing-store enabled");
+
+        tickit_window_flush(root);
+        drain_termlog();
+        is_int(exposed, 1, "chart exposed once initially");
+
+        TickitWindow *popup = tickit_window_new(root, (TickitRect){5, 5, 1, 1}, 0);
+        tickit_window_bind_event(popup, TICKIT_WINDOW_ON_EXPOSE, 0, &on_expose_textat, "P");
+        tickit_window_flush(root);
+
+        is_termlog("Termlog after popup over backed window", GOTO(5, 5), SETPEN(), PRINT("P"),
+            NULL);
+
+        tickit_window_hide(popup);
+        tickit_window_flush(root);
+
+        is_termlog("Termlog after popup hidden from backed window", GOTO(5, 5), SETPEN(),
+            PRINT("0"), NULL);
+        is_int(exposed, 1, "chart not exposed again by popup");
+
+        tickit_window_expose(chart, &(TickitRect){.top = 1, .left = 0, .lines = 1, .cols = 80});
+        tickit_window_flush(root);
+
+        is_int(exposed, 2, "chart exposed again by its own expose");
+
+        tickit_window_scroll(chart, 1, 0);
+        tickit_window_flush(root);
+        drain_termlog();
+
+        is_int(exposed, 3, "chart exposed for the line revealed by scrolling");
+
+        tickit_window_show(popup);
+        tickit_window_flush(root);
+        drain_termlog();
+        tickit_window_hide(popup);
+        tickit_window_flush(root);
+
+        is_termlog("Termlog after popup hidden from scrolled backed window", GOTO(5, 5), SETPEN(),
+            PRINT("1"), NULL);
+        is_int(exposed, 3, "chart not exposed again after scroll by popup");
+
+        tickit_window_setctl_int(chart, TICKIT_WINCTL_BACKING_STORE, 0);
+        tickit_window_getctl_int(chart, TICKIT_WINCTL_BACKING_STORE, &value);
+        is_int(value, 0, "backing-store disabled");
+
+        tickit_window_unref(popup);
+        tickit_window_unref(chart);
+        tickit_window_flush(root);
+        drain_termlog();
+    }
+
+    // Backing store scrolled twice before a flush
+    {
+        TickitWindow *chart = tickit_window_new(root, (TickitRect){5, 0, 6, 80}, 0);
+
+        int offset = 0;
+        tickit_window_bind_event(chart, TICKIT_WINDOW_ON_EXPOSE, 0, &on_expose_render_rows, &offset);
+        tickit_window_setctl_int(chart, TICKIT_WINCTL_BACKING_STORE, 1);
+
+        tickit_window_flush(root);
+        drain_termlog();
+
+        offset++;
+        tickit_window_scroll(chart, 1, 0);
+        offset++;
+        tickit_window_scroll(chart, 1, 0);
+        tickit_window_flush(root);
+        drain_termlog();
+
+        is_display_line(tt, 5, "Row 2     ", "Display line 0 after scrolling backed window twice");
+        is_display_line(tt, 9, "Row 6     ", "Display line 4 after scrolling backed window twice");
+        is_display_line(tt, 10, "Row 7     ", "Display line 5 after scrolling backed window twice");
+
+        tickit_window_unref(chart);
+        tickit_window_flush(root);
+        drain_termlog();
+    }
+
+    // Backing store scrolled with a child window
+    {
+        TickitWindow *chart = tickit_window_new(root, (TickitRect){5, 0, 6, 80}, 0);
+        TickitWindow *child = tickit_window_new(chart, (TickitRect){0, 0, 3, 5}, 0);
+
+        int offset = 0;
+        tickit_window_bind_event(chart, TICKIT_WINDOW_ON_EXPOSE, 0, &on_expose_render_rows, &offset);
+        tickit_window_bind_event(child, TICKIT_WINDOW_ON_EXPOSE, 0, &on_expose_fillX, NULL);
+        tickit_window_setctl_int(chart, TICKIT_WINCTL_BACKING_STORE, 1);
+
+        TickitWindow *popup = tickit_window_new(root, (TickitRect){8, 0, 1, 10}, 0);
+        tickit_window_bind_event(popup, TICKIT_WINDOW_ON_EXPOSE, 0, &on_expose_fillX, NULL);
+
+        tickit_window_flush(root);
+        drain_termlog();
+
+        offset--;
+        tickit_window_scroll(chart, -1, 0);
+        tickit_window_flush(root);
+        drain_termlog();
+
+        tickit_window_hide(popup);
+        tickit_window_flush(root);
+        drain_termlog();
+
+        is_display_line(tt, 7, "XXXXX     ", "Display beside child after scrolling backed window");
+        is_display_line(tt, 8, "Row 2     ", "Display below child after scrolling backed window");
+
+        tickit_window_unref(popup);
+        tickit_window_unref(child);
+        tickit_window_unref(chart);
+        tickit_window_flush(root);
+        drain_termlog();
+    }
+
+    // Backing store exposed in several overlapping areas
+    {
+        TickitWindow *win = tickit_window_new(root, (TickitRect){10, 0, 10, 30}, 0);
+
+        char fill = 'A';
+        tickit_window_bind_event(win, TICKIT_WINDOW_ON_EXPOSE, 0, &on_expose_fill, &fill);
+        tickit_window_setctl_int(win, TICKIT_WINCTL_BACKING_STORE, 1);
+
+        tickit_window_flush(root);
+        drain_termlog();
+
+        fill = 'B';
+        tickit_window_expose(win, &(TickitRect){.top = 3, .left = 11, .lines = 6, .cols = 6});
+        tickit_window_expose(win, &(TickitRect){.top = 4, .left = 14, .lines = 4, .cols = 8});
+        tickit_window_expose(win, &(TickitRect){.top = 4, .left = 11, .lines = 6, .cols = 6});
+        tickit_window_flush(root);
+        drain_termlog();
+
+        is_display_text(tt, 12, 11, "AAAAAAAAAA", "Display above overlapping exposes");
+        is_display_text(tt, 13, 11, "BBBBBBAAAA", "Display of first overlapping expose");
+        is_display_text(tt, 14, 11, "BBBBBBBBBB", "Display of all overlapping exposes");
+        is_display_text(tt, 18, 11, "BBBBBBAAAA", "Display below the wider expose");
+        is_display_text(tt, 19, 11, "BBBBBBAAAA", "Display of last line of overlapping exposes");
+
+        tickit_window_unref(win);
+        tickit_window_flush(root);
+        drain_termlog();
+    }
+
+    // Backing store scrolled with several child windows
+    {
+        TickitWindow *chart  = tickit_window_new(root, (TickitRect){5, 0, 6, 80}, 0);
+        TickitWindow *childA = tickit_window_new(chart, (TickitRect){1, 0, 1, 5}, 0);
+        TickitWindow *childB = tickit_window_new(chart, (TickitRect){3, 2, 2, 4}, 0);
+
+        int offset = 0;
+        tickit_window_bind_event(chart, TICKIT_WINDOW_ON_EXPOSE, 0, &on_expose_render_rows, &offset);
+        tickit_window_bind_event(childA, TICKIT_WINDOW_ON_EXPOSE, 0, &on_expose_fillX, NULL);
+        tickit_window_bind_event(childB, TICKIT_WINDOW_ON_EXPOSE, 0, &on_expose_fillX, NULL);
+        tickit_window_setctl_int(chart, TICKIT_WINCTL_BACKING_STORE, 1);
+
+        tickit_window_flush(root);
+        drain_termlog();
+
+        offset++;
+        tickit_window_scroll(chart, 1, 0);
+        tickit_window_expose(chart, &(TickitRect){.top = 2, .left = 3, .lines = 3, .cols = 10});
+        offset++;
+        tickit_window_scroll(chart, 1, 0);
+        tickit_window_flush(root);
+        drain_termlog();
+
+        is_display_line(tt, 5, "Row 2     ", "Display line 0 after scrolling with children");
+        is_display_line(tt, 6, "XXXXX     ", "Display line 1 after scrolling with children");
+        is_display_line(tt, 7, "Row 4     ", "Display line 2 after scrolling with children");
+        is_display_line(tt, 8, "RoXXXX    ", "Display line 3 after scrolling with children");
+        is_display_line(tt, 9, "RoXXXX    ", "Display line 4 after scrolling with children");
+        is_display_line(tt, 10, "Row 7     ", "Display line 5 after scrolling with children");
+
+        tickit_window_unref(childB);
+        tickit_window_unref(childA);
+        tickit_window_unref(chart);
+        tickit_window_flush(root);
+        drain_termlog();
+    }
+
+    // Backing store of a parent whose child moves
+    {
+        TickitWindow *parent = tickit_window_new(root, (TickitRect){12, 0, 6, 40}, 0);
+        TickitWindow *child  = tickit_window_new(parent, (TickitRect){1, 1, 1, 5}, 0);
+
+        char fill = 'P';
+        tickit_window_bind_event(parent, TICKIT_WINDOW_ON_EXPOSE, 0, &on_expose_fill, &fill);
+        tickit_window_bind_event(child, TICKIT_WINDOW_ON_EXPOSE, 0, &on_expose_fillX, NULL);
+        tickit_window_setctl_int(parent, TICKIT_WINCTL_BACKING_STORE, 1);
+
+        tickit_window_flush(root);
+        drain_termlog();
+
+        tickit_window_reposition(child, 3, 10);
+        tickit_window_expose(root, &(TickitRect){.top = 0, .left = 0, .lines = 25, .cols = 80});
+        tickit_window_flush(root);
+        drain_termlog();
+
+        is_display_line(tt, 13, "PPPPPPPPPP", "Display at old child position after reposition");
+        is_display_text(tt, 15, 10, "XXXXXPPPPP", "Display at new child position after reposition");
+
+        fill = 'Q';
+        tickit_window_expose(root, NULL);
+        tickit_window_flush(root);
+        drain_termlog();
+
+        is_display_line(tt, 12, "QQQQQQQQQQ", "Display of backed parent after whole root expose");
+        is_display_text(tt, 15, 10, "XXXXXQQQQQ", "Display of child after whole root expose");
+
+        tickit_window_unref(child);
+        tickit_window_unref(parent);
+        tickit_window_flush(root);
+        drain_termlog();
+    }
+
+    // Exposing the whole root repaints the terminal
+    {
+        TickitWindow *win = tickit_window_new(root, (TickitRect){2, 10, 1, 20}, 0);
+        tickit_window_bind_event(win, TICKIT_WINDOW_ON_EXPOSE, 0, &on_expose_textat, "Hello");
+
+        tickit_window_flush(root);
+        drain_termlog();
+
+        tickit_window_expose(win, NULL);
+        tickit_window_flush(root);
+
+        is_termlog("Termlog empty after Window expose with unchanged output", NULL);
+
+        tickit_window_expose(root, NULL);
+        tickit_window_flush(root);
+
+        is_termlog("Termlog after root expose", GOTO(2, 10), SETPEN(), PRINT("Hello"), NULL);
+
+        tickit_window_unref(win);
+        tickit_window_flush(root);
+        drain_termlog();
+    }
+
     tickit_window_unref(root);
     tickit_term_unref(tt);
 
@@ -63,8 +63,8 @@ int main(int argc, char *argv[]) {
         tickit_window_flush(root);
 
         is_termlog("Termlog for print under floating window", GOTO(10, 0), SETPEN(),
-            PRINT("XXXXXXXXXX"), GOTO(10, 40), SETPEN(),
-            PRINT("XXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXX"), NULL);
+            PRINT("XXXXXXXXXX"), GOTO(10, 40), PRINT("XXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXX"),
+            NULL);
 
         TickitWindow *win =
             tickit_window_new(root, (TickitRect){10, 20, 1, 50}, TICKIT_WINDOW_LOWEST);